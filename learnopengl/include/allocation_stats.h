@@ -0,0 +1,120 @@
+#ifndef ALLOCATION_STATS_H
+#define ALLOCATION_STATS_H
+
+#include <atomic>
+#include <cstddef>
+
+// Counts heap allocations made through operator new. The counting operator new/delete are only
+// compiled into a program that defines ALLOCATION_STATS_IMPLEMENTATION in exactly one source file
+// before including this header, the counters stay at zero everywhere else.
+//
+// Allocations of at least SizeLogThreshold bytes also have their size written to a small log, so
+// a check can find out how often a buffer of a particular size was allocated.
+
+const size_t ALLOCATION_SIZE_LOG_CAPACITY = 4096;
+
+struct AllocationStats
+{
+public:
+    std::atomic<size_t> Count{0};
+    std::atomic<size_t> Bytes{0};
+
+    // 0 disables the size log
+    std::atomic<size_t> SizeLogThreshold{0};
+    std::atomic<size_t> SizeLogLength{0};
+    size_t SizeLog[ALLOCATION_SIZE_LOG_CAPACITY];
+
+    /// <summary>
+    /// Starts logging the sizes of allocations of at least threshold bytes, clearing the log.
+    /// </summary>
+    void StartSizeLog(size_t threshold)
+    {
+        SizeLogLength = 0;
+        SizeLogThreshold = threshold;
+    }
+
+    void StopSizeLog()
+    {
+        SizeLogThreshold = 0;
+    }
+
+    /// <summary>
+    /// Returns how many logged allocations had exactly the given size.
+    /// </summary>
+    size_t CountLoggedSize(size_t size) const
+    {
+        size_t length = SizeLogLength < ALLOCATION_SIZE_LOG_CAPACITY ? SizeLogLength.load()
+                                                                     : ALLOCATION_SIZE_LOG_CAPACITY;
+        size_t count = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            count += SizeLog[i] == size ? 1 : 0;
+        }
+        return count;
+    }
+
+    void Record(size_t size)
+    {
+        ++Count;
+        Bytes += size;
+
+        size_t threshold = SizeLogThreshold;
+        if (threshold > 0 && size >= threshold)
+        {
+            size_t slot = SizeLogLength++;
+            if (slot < ALLOCATION_SIZE_LOG_CAPACITY)
+            {
+                SizeLog[slot] = size;
+            }
+        }
+    }
+};
+
+inline AllocationStats allocationStats;
+
+#endif
+
+#ifdef ALLOCATION_STATS_IMPLEMENTATION
+#ifndef ALLOCATION_STATS_IMPLEMENTED
+#define ALLOCATION_STATS_IMPLEMENTED
+
+#include <cstdlib>
+#include <new>
+
+void *operator new(size_t size)
+{
+    allocationStats.Record(size);
+    if (void *memory = std::malloc(size > 0 ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+#endif
+#endif
@@ -0,0 +1,473 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <job_system.h>
+#include <pose_math.h>
+#include <shader.h>
+
+using std::string;
+using std::vector;
+
+// size of the bone matrix array in the skinning shaders, see shaders/3.11.1.skinning.vs
+#define MAX_BONES 100
+
+/// <summary>
+/// A bone of a model. The offset matrix takes a vertex from mesh space into the bone's space in
+/// the bind pose.
+/// </summary>
+struct BoneInfo
+{
+    int ID; // index into the bone matrix array
+    glm::mat4 Offset;
+};
+
+/// <summary>
+/// The node hierarchy of a model with its bones mapped onto the nodes, shared read only by every
+/// Animator that poses it. Nodes are in the order of Model::Nodes, parents first.
+/// </summary>
+struct Skeleton
+{
+    vector<string> NodeNames;
+    vector<int> Parents;              // -1 for roots
+    vector<glm::mat4> RestTransforms; // node transforms relative to the parent, as imported
+    vector<int> BoneNodes;            // node of each bone ID, -1 if the bone has no node
+    vector<glm::mat4> BoneOffsets;    // BoneInfo::Offset of each bone ID
+
+    int FindNode(const string &name) const
+    {
+        for (size_t i = 0; i < NodeNames.size(); ++i)
+        {
+            if (NodeNames[i] == name)
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    size_t GetBoneCount() const
+    {
+        return BoneNodes.size();
+    }
+};
+
+/// <summary>
+/// The keyframes of one animated node. Times are in seconds, each track has at least one key.
+/// </summary>
+struct AnimationChannel
+{
+    int Node; // into the Skeleton the animation was loaded for
+    vector<float> PositionTimes;
+    vector<glm::vec3> Positions;
+    vector<float> RotationTimes;
+    vector<glm::quat> Rotations;
+    vector<float> ScaleTimes;
+    vector<glm::vec3> Scales;
+};
+
+/// <summary>
+/// The keys each track of a channel was last sampled at, kept per Animator.
+/// </summary>
+struct AnimationKeyCache
+{
+    unsigned int Position = 0;
+    unsigned int Rotation = 0;
+    unsigned int Scale = 0;
+};
+
+/// <summary>
+/// Returns the key whose interval contains time, clamped to the first and last interval. Playback
+/// usually stays on the cached key or moves on to the next one, only jumps and loops search.
+/// </summary>
+inline unsigned int FindKeyframe(const vector<float> &times, float time, unsigned int cached)
+{
+    unsigned int last = static_cast<unsigned int>(times.size()) - 2;
+    for (unsigned int key = cached; key <= last && key <= cached + 1; ++key)
+    {
+        if (times[key] <= time && time < times[key + 1])
+        {
+            return key;
+        }
+    }
+    auto next = std::upper_bound(times.begin() + 1, times.end() - 1, time);
+    return static_cast<unsigned int>(next - times.begin()) - 1;
+}
+
+/// <summary>
+/// How far time is between a key and the next one, in [0, 1].
+/// </summary>
+inline float GetKeyframeFactor(const vector<float> &times, unsigned int key, float time)
+{
+    float length = times[key + 1] - times[key];
+    float factor = length > 0.0f ? (time - times[key]) / length : 0.0f;
+    return factor < 0.0f ? 0.0f : (factor > 1.0f ? 1.0f : factor);
+}
+
+/// <summary>
+/// One animation of a file, with its channels resolved to the nodes of a skeleton once on load.
+/// </summary>
+struct Animation
+{
+public:
+    string Name;
+    float Duration = 0.0f; // seconds
+    vector<AnimationChannel> Channels;
+
+    /// <summary>
+    /// Loads the animation at index from a file, usually the one the model came from. Channels of
+    /// nodes the skeleton doesn't have are dropped.
+    /// </summary>
+    Animation(const string &path, const Skeleton &skeleton, unsigned int index = 0)
+    {
+        Assimp::Importer importer;
+        const aiScene *scene = importer.ReadFile(path, 0);
+        if (!scene || !scene->mRootNode || index >= scene->mNumAnimations)
+        {
+            std::cout << "ERROR::ANIMATION:: No animation " << index << " in " << path << std::endl;
+            return;
+        }
+
+        const aiAnimation *animation = scene->mAnimations[index];
+        // files may leave the tick rate out, 25 is what assimp assumes then
+        double ticksPerSecond = animation->mTicksPerSecond != 0.0 ? animation->mTicksPerSecond
+                                                                   : 25.0;
+        Name = animation->mName.C_Str();
+        Duration = static_cast<float>(animation->mDuration / ticksPerSecond);
+
+        Channels.reserve(animation->mNumChannels);
+        for (unsigned int i = 0; i < animation->mNumChannels; ++i)
+        {
+            const aiNodeAnim *source = animation->mChannels[i];
+            int node = skeleton.FindNode(source->mNodeName.C_Str());
+            if (node < 0 || source->mNumPositionKeys == 0 || source->mNumRotationKeys == 0 ||
+                source->mNumScalingKeys == 0)
+            {
+                continue;
+            }
+
+            AnimationChannel channel;
+            channel.Node = node;
+            auto toSeconds = [ticksPerSecond](double ticks)
+            { return static_cast<float>(ticks / ticksPerSecond); };
+            for (unsigned int key = 0; key < source->mNumPositionKeys; ++key)
+            {
+                const aiVectorKey &position = source->mPositionKeys[key];
+                channel.PositionTimes.push_back(toSeconds(position.mTime));
+                channel.Positions.push_back(
+                    glm::vec3(position.mValue.x, position.mValue.y, position.mValue.z));
+            }
+            for (unsigned int key = 0; key < source->mNumRotationKeys; ++key)
+            {
+                const aiQuatKey &rotation = source->mRotationKeys[key];
+                channel.RotationTimes.push_back(toSeconds(rotation.mTime));
+                channel.Rotations.push_back(glm::quat(
+                    rotation.mValue.w, rotation.mValue.x, rotation.mValue.y, rotation.mValue.z));
+            }
+            for (unsigned int key = 0; key < source->mNumScalingKeys; ++key)
+            {
+                const aiVectorKey &scale = source->mScalingKeys[key];
+                channel.ScaleTimes.push_back(toSeconds(scale.mTime));
+                channel.Scales.push_back(glm::vec3(scale.mValue.x, scale.mValue.y, scale.mValue.z));
+            }
+            Channels.push_back(std::move(channel));
+        }
+    }
+
+    bool IsLoaded() const
+    {
+        return Duration > 0.0f && !Channels.empty();
+    }
+};
+
+/// <summary>
+/// Poses one character: samples an animation, walks the hierarchy and produces the bone matrices
+/// for the skinning shader. All buffers are sized when the animation starts playing, so Update
+/// doesn't allocate. Many animators can share one Skeleton and Animation.
+///
+/// The bone matrices are double buffered: Evaluate writes the back palette and SwapBoneMatrices
+/// publishes it, so the render thread can keep reading last frame's pose while worker threads
+/// evaluate the next one (see AnimationBatch). Update does both for single threaded use.
+/// </summary>
+struct Animator
+{
+public:
+    explicit Animator(const Skeleton &skeleton)
+        : Rig(&skeleton),
+          LocalTransforms(skeleton.RestTransforms),
+          GlobalTransforms(skeleton.RestTransforms.size(), glm::mat4(1.0f)),
+          BoneMatrices{vector<glm::mat4>(skeleton.GetBoneCount(), glm::mat4(1.0f)),
+                       vector<glm::mat4>(skeleton.GetBoneCount(), glm::mat4(1.0f))}
+    {
+    }
+
+    void Play(const Animation *animation, bool loop = true)
+    {
+        Current = animation;
+        Loop = loop;
+        Time = 0.0f;
+        KeyCaches.assign(animation != nullptr ? animation->Channels.size() : 0,
+                         AnimationKeyCache());
+        EvaluatePose();
+        SwapBoneMatrices();
+    }
+
+    /// <summary>
+    /// Advances the animation and publishes the new pose.
+    /// </summary>
+    void Update(float deltaTime)
+    {
+        Evaluate(deltaTime);
+        SwapBoneMatrices();
+    }
+
+    /// <summary>
+    /// Advances the animation and computes the new pose into the back palette. Animators share no
+    /// mutable state, so different ones can be evaluated on different threads.
+    /// </summary>
+    void Evaluate(float deltaTime)
+    {
+        if (Current == nullptr)
+        {
+            return;
+        }
+
+        Time += deltaTime;
+        if (Time > Current->Duration)
+        {
+            Time = Loop && Current->Duration > 0.0f ? std::fmod(Time, Current->Duration)
+                                                     : Current->Duration;
+        }
+        EvaluatePose();
+    }
+
+    /// <summary>
+    /// Makes the last evaluated pose the one GetBoneMatrices returns.
+    /// </summary>
+    void SwapBoneMatrices()
+    {
+        FrontPalette ^= 1;
+    }
+
+    /// <summary>
+    /// The published bone matrices by bone ID, each takes a vertex from mesh space to its posed
+    /// position in model space.
+    /// </summary>
+    const vector<glm::mat4> &GetBoneMatrices() const
+    {
+        return BoneMatrices[FrontPalette];
+    }
+
+    float GetTime() const
+    {
+        return Time;
+    }
+
+private:
+    const Skeleton *Rig;
+    const Animation *Current = nullptr;
+    bool Loop = true;
+    float Time = 0.0f; // seconds
+    vector<AnimationKeyCache> KeyCaches; // per channel of Current
+    vector<glm::mat4> LocalTransforms;
+    vector<glm::mat4> GlobalTransforms;
+    vector<glm::mat4> BoneMatrices[2]; // published and back palette
+    unsigned int FrontPalette = 0;
+
+    void EvaluatePose()
+    {
+        // nodes without a channel stay in their rest pose
+        LocalTransforms = Rig->RestTransforms;
+        if (Current != nullptr)
+        {
+            for (size_t i = 0; i < Current->Channels.size(); ++i)
+            {
+                const AnimationChannel &channel = Current->Channels[i];
+                LocalTransforms[channel.Node] = SampleChannel(channel, KeyCaches[i]);
+            }
+        }
+
+        // parents come first, so every parent is done before its children
+        for (size_t node = 0; node < LocalTransforms.size(); ++node)
+        {
+            int parent = Rig->Parents[node];
+            GlobalTransforms[node] =
+                parent >= 0 ? MultiplyTransforms(GlobalTransforms[parent], LocalTransforms[node])
+                            : LocalTransforms[node];
+        }
+
+        vector<glm::mat4> &boneMatrices = BoneMatrices[FrontPalette ^ 1];
+        for (size_t bone = 0; bone < boneMatrices.size(); ++bone)
+        {
+            int node = Rig->BoneNodes[bone];
+            if (node < 0)
+            {
+                boneMatrices[bone] = glm::mat4(1.0f);
+                continue;
+            }
+            boneMatrices[bone] = MultiplyTransforms(GlobalTransforms[node], Rig->BoneOffsets[bone]);
+        }
+    }
+
+    glm::mat4 SampleChannel(const AnimationChannel &channel, AnimationKeyCache &cache) const
+    {
+        glm::vec3 position = channel.Positions[0];
+        if (channel.Positions.size() > 1)
+        {
+            cache.Position = FindKeyframe(channel.PositionTimes, Time, cache.Position);
+            float factor = GetKeyframeFactor(channel.PositionTimes, cache.Position, Time);
+            position = glm::mix(
+                channel.Positions[cache.Position], channel.Positions[cache.Position + 1], factor);
+        }
+
+        glm::quat rotation = channel.Rotations[0];
+        if (channel.Rotations.size() > 1)
+        {
+            cache.Rotation = FindKeyframe(channel.RotationTimes, Time, cache.Rotation);
+            float factor = GetKeyframeFactor(channel.RotationTimes, cache.Rotation, Time);
+            rotation = SlerpRotations(
+                channel.Rotations[cache.Rotation], channel.Rotations[cache.Rotation + 1], factor);
+        }
+
+        glm::vec3 scale = channel.Scales[0];
+        if (channel.Scales.size() > 1)
+        {
+            cache.Scale = FindKeyframe(channel.ScaleTimes, Time, cache.Scale);
+            float factor = GetKeyframeFactor(channel.ScaleTimes, cache.Scale, Time);
+            scale = glm::mix(channel.Scales[cache.Scale], channel.Scales[cache.Scale + 1], factor);
+        }
+
+        return ComposeTransform(position, rotation, scale);
+    }
+};
+
+// characters evaluated per job, enough work to outweigh handing the job out
+const size_t ANIMATION_CHARACTERS_PER_JOB = 8;
+
+/// <summary>
+/// Evaluates the poses of many characters on the job system. Begin queues the work and returns
+/// right away, so the render thread can draw with the poses published last frame in the meantime.
+/// Finish waits for the jobs and publishes the new poses.
+/// </summary>
+struct AnimationBatch
+{
+public:
+    AnimationBatch() = default;
+
+    // the queued jobs point at the batch
+    AnimationBatch(const AnimationBatch &) = delete;
+    AnimationBatch &operator=(const AnimationBatch &) = delete;
+
+    ~AnimationBatch()
+    {
+        Finish();
+    }
+
+    void Begin(vector<Animator> &animators, float deltaTime, JobSystem &jobs = JobSystem::Get())
+    {
+        Finish();
+        Animators = &animators;
+        DeltaTime = deltaTime;
+        Jobs = &jobs;
+        jobs.Dispatch(
+            animators.size(), ANIMATION_CHARACTERS_PER_JOB, &EvaluateRange, this, Counter);
+    }
+
+    void Finish()
+    {
+        if (Jobs == nullptr)
+        {
+            return;
+        }
+        Jobs->Wait(Counter);
+        for (Animator &animator : *Animators)
+        {
+            animator.SwapBoneMatrices();
+        }
+        Jobs = nullptr;
+    }
+
+private:
+    vector<Animator> *Animators = nullptr;
+    float DeltaTime = 0.0f;
+    JobSystem *Jobs = nullptr; // set while a batch is in flight
+    JobCounter Counter;
+
+    static void EvaluateRange(void *data, size_t begin, size_t end)
+    {
+        AnimationBatch &batch = *static_cast<AnimationBatch *>(data);
+        for (size_t i = begin; i < end; ++i)
+        {
+            (*batch.Animators)[i].Evaluate(batch.DeltaTime);
+        }
+    }
+};
+
+/// <summary>
+/// Uniform buffer holding the bone matrices of one character for the BoneMatrices block of the
+/// skinning shaders. Each upload orphans the old contents, so characters can be uploaded and drawn
+/// one after another through the same buffer without waiting on the GPU.
+/// </summary>
+struct BoneMatrixBuffer
+{
+public:
+    BoneMatrixBuffer() = default;
+
+    ~BoneMatrixBuffer()
+    {
+        glDeleteBuffers(1, &UBO);
+    }
+
+    // owns a GL buffer, so it can be moved but not copied
+    BoneMatrixBuffer(const BoneMatrixBuffer &) = delete;
+    BoneMatrixBuffer &operator=(const BoneMatrixBuffer &) = delete;
+
+    BoneMatrixBuffer(BoneMatrixBuffer &&other) noexcept : UBO(std::exchange(other.UBO, 0))
+    {
+    }
+
+    BoneMatrixBuffer &operator=(BoneMatrixBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            glDeleteBuffers(1, &UBO);
+            UBO = std::exchange(other.UBO, 0);
+        }
+        return *this;
+    }
+
+    /// <summary>
+    /// Uploads the matrices and binds the buffer to BONE_MATRICES_BINDING. Bones past MAX_BONES
+    /// are dropped.
+    /// </summary>
+    void Upload(const vector<glm::mat4> &boneMatrices)
+    {
+        if (UBO == 0)
+        {
+            glGenBuffers(1, &UBO);
+        }
+        size_t count = std::min<size_t>(boneMatrices.size(), MAX_BONES);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, MAX_BONES * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, count * sizeof(glm::mat4), boneMatrices.data());
+        glBindBufferBase(GL_UNIFORM_BUFFER, BONE_MATRICES_BINDING, UBO);
+    }
+
+private:
+    unsigned int UBO = 0;
+};
+
+#endif
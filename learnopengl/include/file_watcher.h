@@ -0,0 +1,178 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+using std::vector;
+
+/// <summary>
+/// Reports files that were written since the last Poll. On Linux it listens to inotify events of
+/// the files' directories, so editors that save by renaming a new file over the old one are seen
+/// too and polling costs one read that returns right away. Elsewhere it compares the files' write
+/// times on every Poll.
+/// </summary>
+struct FileWatcher
+{
+public:
+    FileWatcher()
+    {
+#ifdef __linux__
+        Descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (Descriptor < 0)
+        {
+            std::cout << "ERROR::FILE_WATCHER::INOTIFY_INIT_FAILED" << std::endl;
+        }
+#endif
+    }
+
+    ~FileWatcher()
+    {
+#ifdef __linux__
+        if (Descriptor >= 0)
+        {
+            close(Descriptor); // drops every watch with it
+        }
+#endif
+    }
+
+    // owns the inotify descriptor
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    /// <summary>
+    /// Starts watching a file. Returns false if it can't be watched.
+    /// </summary>
+    bool Watch(const string &path)
+    {
+        string file = Normalize(path);
+        if (Files.count(file) != 0)
+        {
+            return true;
+        }
+#ifdef __linux__
+        if (Descriptor < 0)
+        {
+            return false;
+        }
+        string directory = std::filesystem::path(file).parent_path().string();
+        if (directory.empty())
+        {
+            directory = ".";
+        }
+        bool watched = false;
+        for (const auto &entry : Directories)
+        {
+            watched = watched || entry.second == directory;
+        }
+        if (!watched)
+        {
+            int watch =
+                inotify_add_watch(Descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (watch < 0)
+            {
+                std::cout << "ERROR::FILE_WATCHER::WATCH_FAILED: " << directory << std::endl;
+                return false;
+            }
+            Directories.emplace(watch, directory);
+        }
+        Files.emplace(file, std::filesystem::file_time_type());
+#else
+        std::error_code error;
+        Files.emplace(file, std::filesystem::last_write_time(file, error));
+#endif
+        return true;
+    }
+
+    /// <summary>
+    /// Returns the watched files written since the last call, each once.
+    /// </summary>
+    vector<string> Poll()
+    {
+        vector<string> changed;
+#ifdef __linux__
+        if (Descriptor < 0)
+        {
+            return changed;
+        }
+        alignas(inotify_event) char buffer[4096];
+        while (true)
+        {
+            ssize_t length = read(Descriptor, buffer, sizeof(buffer));
+            if (length <= 0)
+            {
+                break; // EAGAIN once every pending event was read
+            }
+            for (ssize_t offset = 0; offset < length;)
+            {
+                const inotify_event *event =
+                    reinterpret_cast<const inotify_event *>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+                auto directory = Directories.find(event->wd);
+                if (event->len == 0 || directory == Directories.end())
+                {
+                    continue;
+                }
+                string file = Normalize(directory->second + "/" + event->name);
+                if (Files.count(file) != 0)
+                {
+                    AddOnce(changed, file);
+                }
+            }
+        }
+#else
+        for (auto &entry : Files)
+        {
+            std::error_code error;
+            std::filesystem::file_time_type time =
+                std::filesystem::last_write_time(entry.first, error);
+            if (!error && time != entry.second)
+            {
+                entry.second = time;
+                changed.push_back(entry.first);
+            }
+        }
+#endif
+        return changed;
+    }
+
+    /// <summary>
+    /// The form paths are watched and reported in, so they can be compared as strings.
+    /// </summary>
+    static string Normalize(const string &path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+private:
+    // watched file -> last seen write time, the time is only used without inotify
+    std::unordered_map<string, std::filesystem::file_time_type> Files;
+#ifdef __linux__
+    int Descriptor = -1;
+    // inotify watch -> directory it watches
+    std::unordered_map<int, string> Directories;
+#endif
+
+    static void AddOnce(vector<string> &files, const string &file)
+    {
+        for (const string &existing : files)
+        {
+            if (existing == file)
+            {
+                return;
+            }
+        }
+        files.push_back(file);
+    }
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <iostream>
+
+// Counters for driver work issued during a single frame. The render loop resets them at the start
+// of every frame and can print them to compare how many GL calls a scene costs.
+struct FrameStats
+{
+public:
+    // glGetUniformLocation calls made against the driver
+    unsigned int UniformLocationQueries = 0;
+    // name -> location lookups served from a Shader's cached table instead of the driver
+    unsigned int UniformTableLookups = 0;
+    // glDraw* calls
+    unsigned int DrawCalls = 0;
+    // triangles those calls drew, instances included
+    unsigned long long TrianglesDrawn = 0;
+    // glBindVertexArray calls made to draw
+    unsigned int VertexArrayBinds = 0;
+    // glUseProgram calls
+    unsigned int ProgramBinds = 0;
+    // glBindTexture calls made to draw
+    unsigned int TextureBinds = 0;
+    // meshes that passed or failed frustum culling
+    unsigned int MeshesVisible = 0;
+    unsigned int MeshesCulled = 0;
+    // meshlets of the visible meshes that passed or failed cluster culling
+    unsigned int MeshletsVisible = 0;
+    unsigned int MeshletsCulled = 0;
+
+    /// <summary>
+    /// Clears every counter, called at the start of a frame.
+    /// </summary>
+    void Reset()
+    {
+        *this = FrameStats();
+    }
+
+    /// <summary>
+    /// Writes the counters of the last frame to the console.
+    /// </summary>
+    void Print() const
+    {
+        std::cout << "FRAME_STATS:: draws: " << DrawCalls << " | triangles: " << TrianglesDrawn
+                  << " | program binds: " << ProgramBinds
+                  << " | texture binds: " << TextureBinds << " | VAO binds: " << VertexArrayBinds
+                  << " | glGetUniformLocation: " << UniformLocationQueries
+                  << " | cached uniform lookups: " << UniformTableLookups
+                  << " | visible meshes: " << MeshesVisible << " | culled: " << MeshesCulled
+                  << " | visible meshlets: " << MeshletsVisible
+                  << " | culled: " << MeshletsCulled << std::endl;
+    }
+};
+
+// the stats for the frame currently being rendered
+inline FrameStats frameStats;
+
+#endif
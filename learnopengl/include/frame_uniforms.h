@@ -0,0 +1,53 @@
+#ifndef FRAME_UNIFORMS_H
+#define FRAME_UNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <shader.h>
+#include <stream_buffer.h>
+
+/// <summary>
+/// The Matrices uniform block of the shaders in std140 layout, two mat4 need no padding.
+/// </summary>
+struct FrameMatrices
+{
+    glm::mat4 Projection;
+    glm::mat4 View;
+};
+
+/// <summary>
+/// Camera data shared by all programs through the Matrices block. Uploaded once per frame into a
+/// StreamBuffer and bound to MATRICES_BINDING, which every program's block is connected to when
+/// it is linked, so no program has its camera uniforms set one by one.
+/// </summary>
+struct FrameUniforms
+{
+public:
+    FrameUniforms() : Stream(GL_UNIFORM_BUFFER, sizeof(FrameMatrices))
+    {
+    }
+
+    /// <summary>
+    /// Uploads the camera of the frame and binds it, call it once per frame before drawing.
+    /// </summary>
+    void Upload(const glm::mat4 &projection, const glm::mat4 &view)
+    {
+        FrameMatrices matrices;
+        matrices.Projection = projection;
+        matrices.View = view;
+
+        Stream.BeginFrame();
+        StreamAllocation allocation = Stream.Write(&matrices, 1);
+        Stream.Commit();
+        if (allocation.Data != nullptr)
+        {
+            Stream.BindRange(MATRICES_BINDING, allocation);
+        }
+    }
+
+private:
+    StreamBuffer Stream;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using std::vector;
+
+/// <summary>
+/// The six planes of a view frustum in world space, normals pointing inwards. A point p is inside
+/// a plane when dot(plane.xyz, p) + plane.w >= 0.
+/// </summary>
+struct Frustum
+{
+    glm::vec4 Planes[6];
+
+    /// <summary>
+    /// Extracts the planes from a projection * view matrix (Gribb and Hartmann).
+    /// </summary>
+    static Frustum FromMatrix(const glm::mat4 &viewProjection)
+    {
+        // glm is column major, row i of the matrix is (m[0][i], m[1][i], m[2][i], m[3][i])
+        const glm::mat4 &m = viewProjection;
+        auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+        glm::vec4 x = row(0);
+        glm::vec4 y = row(1);
+        glm::vec4 z = row(2);
+        glm::vec4 w = row(3);
+
+        Frustum frustum;
+        frustum.Planes[0] = w + x; // left
+        frustum.Planes[1] = w - x; // right
+        frustum.Planes[2] = w + y; // bottom
+        frustum.Planes[3] = w - y; // top
+        frustum.Planes[4] = w + z; // near
+        frustum.Planes[5] = w - z; // far
+        for (glm::vec4 &plane : frustum.Planes)
+        {
+            float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            plane /= length;
+        }
+        return frustum;
+    }
+};
+
+/// <summary>
+/// Tests a batch of axis aligned boxes against a frustum. The boxes are kept as separate arrays of
+/// centers and half extents, so Cull is one straight loop over all boxes per plane with no
+/// branches, which the compiler turns into SIMD code testing several boxes per iteration.
+/// </summary>
+struct FrustumCuller
+{
+public:
+    void Clear()
+    {
+        CenterX.clear();
+        CenterY.clear();
+        CenterZ.clear();
+        ExtentX.clear();
+        ExtentY.clear();
+        ExtentZ.clear();
+        Visible.clear();
+    }
+
+    /// <summary>
+    /// Adds a box given in object space, moved into world space by transform. Returns its index.
+    /// </summary>
+    size_t Add(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::mat4 &transform)
+    {
+        glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+        glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+
+        // the box around the transformed box: the center moves, the extents go through |M|
+        glm::vec3 worldCenter = glm::vec3(transform * glm::vec4(center, 1.0f));
+        glm::vec3 worldExtent(0.0f);
+        for (int column = 0; column < 3; ++column)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                worldExtent[row] += std::fabs(transform[column][row]) * extent[column];
+            }
+        }
+
+        CenterX.push_back(worldCenter.x);
+        CenterY.push_back(worldCenter.y);
+        CenterZ.push_back(worldCenter.z);
+        ExtentX.push_back(worldExtent.x);
+        ExtentY.push_back(worldExtent.y);
+        ExtentZ.push_back(worldExtent.z);
+        return CenterX.size() - 1;
+    }
+
+    /// <summary>
+    /// Marks every box that is at least partly inside the frustum, returns how many are.
+    /// </summary>
+    size_t Cull(const Frustum &frustum)
+    {
+        size_t count = CenterX.size();
+        Visible.assign(count, 1);
+
+        const float *centerX = CenterX.data();
+        const float *centerY = CenterY.data();
+        const float *centerZ = CenterZ.data();
+        const float *extentX = ExtentX.data();
+        const float *extentY = ExtentY.data();
+        const float *extentZ = ExtentZ.data();
+        uint8_t *visible = Visible.data();
+        for (const glm::vec4 &plane : frustum.Planes)
+        {
+            float nx = plane.x, ny = plane.y, nz = plane.z, d = plane.w;
+            float ax = std::fabs(nx), ay = std::fabs(ny), az = std::fabs(nz);
+            for (size_t i = 0; i < count; ++i)
+            {
+                // distance of the center and how far the box reaches towards the plane
+                float distance = nx * centerX[i] + ny * centerY[i] + nz * centerZ[i] + d;
+                float radius = ax * extentX[i] + ay * extentY[i] + az * extentZ[i];
+                visible[i] &= static_cast<uint8_t>(distance + radius >= 0.0f);
+            }
+        }
+
+        size_t visibleCount = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            visibleCount += visible[i];
+        }
+        return visibleCount;
+    }
+
+    bool IsVisible(size_t index) const
+    {
+        return Visible[index] != 0;
+    }
+
+    size_t GetCount() const
+    {
+        return CenterX.size();
+    }
+
+private:
+    vector<float> CenterX, CenterY, CenterZ;
+    vector<float> ExtentX, ExtentY, ExtentZ;
+    vector<uint8_t> Visible;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+#include <iostream>
+
+// glad was generated for the OpenGL 3.3 core profile. Newer entry points the code can make use of
+// are loaded here by hand, and only called when the context supports them.
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void(APIENTRYP GLBufferStorageProc)(GLenum target,
+                                            GLsizeiptr size,
+                                            const void *data,
+                                            GLbitfield flags);
+typedef void(APIENTRYP GLGetProgramBinaryProc)(GLuint program,
+                                               GLsizei bufferSize,
+                                               GLsizei *length,
+                                               GLenum *binaryFormat,
+                                               void *binary);
+typedef void(APIENTRYP GLProgramBinaryProc)(GLuint program,
+                                            GLenum binaryFormat,
+                                            const void *binary,
+                                            GLsizei length);
+typedef void(APIENTRYP GLProgramParameteriProc)(GLuint program, GLenum name, GLint value);
+typedef void(APIENTRYP GLMaxShaderCompilerThreadsProc)(GLuint count);
+
+/// <summary>
+/// The optional OpenGL features of the current context. Load once after gladLoadGLLoader, every
+/// feature that is missing stays false and its functions nullptr.
+/// </summary>
+struct GLExtensions
+{
+public:
+    // glBufferStorage, core in 4.4 or GL_ARB_buffer_storage: immutable buffers that can stay mapped
+    bool HasBufferStorage = false;
+    GLBufferStorageProc BufferStorage = nullptr;
+    // glGetProgramBinary and glProgramBinary, core in 4.1 or GL_ARB_get_program_binary: linked
+    // programs saved and restored without compiling. Also needs at least one binary format
+    bool HasProgramBinary = false;
+    GLGetProgramBinaryProc GetProgramBinary = nullptr;
+    GLProgramBinaryProc ProgramBinary = nullptr;
+    GLProgramParameteriProc ProgramParameteri = nullptr;
+    // GL_KHR_parallel_shader_compile or its ARB twin: compiles and links run on driver threads
+    // and GL_COMPLETION_STATUS_KHR asks whether one is done without waiting for it
+    bool HasParallelShaderCompile = false;
+    GLMaxShaderCompilerThreadsProc MaxShaderCompilerThreads = nullptr;
+
+    static GLExtensions &Get()
+    {
+        static GLExtensions instance;
+        return instance;
+    }
+
+    void Load(GLADloadproc load)
+    {
+        if (IsVersion(4, 4) || IsSupported("GL_ARB_buffer_storage"))
+        {
+            BufferStorage = reinterpret_cast<GLBufferStorageProc>(load("glBufferStorage"));
+            HasBufferStorage = BufferStorage != nullptr;
+        }
+        if (IsVersion(4, 1) || IsSupported("GL_ARB_get_program_binary"))
+        {
+            GetProgramBinary = reinterpret_cast<GLGetProgramBinaryProc>(load("glGetProgramBinary"));
+            ProgramBinary = reinterpret_cast<GLProgramBinaryProc>(load("glProgramBinary"));
+            ProgramParameteri =
+                reinterpret_cast<GLProgramParameteriProc>(load("glProgramParameteri"));
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            HasProgramBinary = GetProgramBinary != nullptr && ProgramBinary != nullptr &&
+                               ProgramParameteri != nullptr && formats > 0;
+        }
+        if (IsSupported("GL_KHR_parallel_shader_compile"))
+        {
+            MaxShaderCompilerThreads = reinterpret_cast<GLMaxShaderCompilerThreadsProc>(
+                load("glMaxShaderCompilerThreadsKHR"));
+        }
+        else if (IsSupported("GL_ARB_parallel_shader_compile"))
+        {
+            MaxShaderCompilerThreads = reinterpret_cast<GLMaxShaderCompilerThreadsProc>(
+                load("glMaxShaderCompilerThreadsARB"));
+        }
+        HasParallelShaderCompile = MaxShaderCompilerThreads != nullptr;
+        if (HasParallelShaderCompile)
+        {
+            MaxShaderCompilerThreads(0xFFFFFFFF); // as many threads as the driver likes
+        }
+    }
+
+    /// <summary>
+    /// Returns true if the context lists the extension.
+    /// </summary>
+    static bool IsSupported(const char *name)
+    {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i)
+        {
+            const char *extension =
+                reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (extension != nullptr && std::strcmp(extension, name) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool IsVersion(int major, int minor)
+    {
+        return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+    }
+
+    void Print() const
+    {
+        std::cout << "GL_EXT:: OpenGL " << GLVersion.major << "." << GLVersion.minor
+                  << " | buffer storage: " << (HasBufferStorage ? "yes" : "no")
+                  << " | program binary: " << (HasProgramBinary ? "yes" : "no")
+                  << " | parallel shader compile: " << (HasParallelShaderCompile ? "yes" : "no")
+                  << std::endl;
+    }
+};
+
+/// <summary>
+/// Loads the optional features, call it right after gladLoadGLLoader with the same loader.
+/// </summary>
+inline void LoadGLExtensions(GLADloadproc load)
+{
+    GLExtensions::Get().Load(load);
+}
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+// jobs one queue holds, Dispatch runs jobs right away when the queue of its thread is full
+const size_t JOB_QUEUE_CAPACITY = 4096;
+
+typedef void (*JobFunction)(void *data, size_t begin, size_t end);
+
+/// <summary>
+/// Counts the unfinished jobs of one or more dispatches, JobSystem::Wait returns once it is zero.
+/// </summary>
+struct JobCounter
+{
+    std::atomic<size_t> Pending{0};
+
+    bool IsDone() const
+    {
+        return Pending.load(std::memory_order_acquire) == 0;
+    }
+};
+
+/// <summary>
+/// A range of work items for a function. Jobs are plain values, dispatching them allocates
+/// nothing.
+/// </summary>
+struct Job
+{
+    JobFunction Function;
+    void *Data;
+    size_t Begin;
+    size_t End;
+    JobCounter *Counter;
+};
+
+/// <summary>
+/// The fixed size double ended job queue of one thread. The owner pushes and pops at the back, so
+/// it keeps working on what it queued last while that data is still in its cache. Other threads
+/// steal from the front. Each queue has its own lock, threads only meet when one is stealing.
+/// </summary>
+struct JobQueue
+{
+public:
+    JobQueue() : Jobs(JOB_QUEUE_CAPACITY)
+    {
+    }
+
+    bool Push(const Job &job)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (Count == Jobs.size())
+        {
+            return false;
+        }
+        Jobs[(Head + Count) % Jobs.size()] = job;
+        ++Count;
+        return true;
+    }
+
+    bool Pop(Job &job)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (Count == 0)
+        {
+            return false;
+        }
+        --Count;
+        job = Jobs[(Head + Count) % Jobs.size()];
+        return true;
+    }
+
+    bool Steal(Job &job)
+    {
+        std::lock_guard<std::mutex> lock(Mutex);
+        if (Count == 0)
+        {
+            return false;
+        }
+        job = Jobs[Head];
+        Head = (Head + 1) % Jobs.size();
+        --Count;
+        return true;
+    }
+
+private:
+    std::mutex Mutex;
+    vector<Job> Jobs; // ring buffer
+    size_t Head = 0;
+    size_t Count = 0;
+};
+
+/// <summary>
+/// Work stealing job system with a persistent pool of worker threads. Every thread has its own
+/// queue, an idle worker takes jobs from the others, and workers sleep while there is nothing to
+/// do. Threads outside the pool share queue 0 and work along with the pool while they Wait.
+/// </summary>
+struct JobSystem
+{
+public:
+    static JobSystem &Get()
+    {
+        static JobSystem instance;
+        return instance;
+    }
+
+    /// <summary>
+    /// Starts workerCount threads, 0 means one per core besides the calling thread.
+    /// </summary>
+    explicit JobSystem(unsigned int workerCount = 0)
+        : WorkerCount(workerCount > 0 ? workerCount : DefaultWorkerCount()),
+          Queues(WorkerCount + 1)
+    {
+        Workers.reserve(WorkerCount);
+        for (unsigned int i = 1; i <= WorkerCount; ++i)
+        {
+            Workers.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(SleepMutex);
+            Stopping = true;
+        }
+        WakeUp.notify_all();
+        for (std::thread &worker : Workers)
+        {
+            worker.join();
+        }
+    }
+
+    // the workers point back at the system, it can't move
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /// <summary>
+    /// Splits [0, count) into jobs of grain items each and queues them, without waiting for them.
+    /// data has to stay valid until the counter is done.
+    /// </summary>
+    void Dispatch(size_t count, size_t grain, JobFunction function, void *data, JobCounter &counter)
+    {
+        grain = std::max<size_t>(grain, 1);
+        JobQueue &queue = Queues[GetQueueIndex()];
+        for (size_t begin = 0; begin < count; begin += grain)
+        {
+            Job job{function, data, begin, std::min(begin + grain, count), &counter};
+            counter.Pending.fetch_add(1, std::memory_order_relaxed);
+
+            // counted before it is pushed, so a worker never sees fewer jobs than there are
+            QueuedJobs.fetch_add(1, std::memory_order_release);
+            if (!queue.Push(job))
+            {
+                QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+                Execute(job);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(SleepMutex);
+        }
+        WakeUp.notify_all();
+    }
+
+    /// <summary>
+    /// Runs queued jobs on the calling thread until every job of the counter is done.
+    /// </summary>
+    void Wait(JobCounter &counter)
+    {
+        size_t index = GetQueueIndex();
+        while (!counter.IsDone())
+        {
+            Job job;
+            if (FindJob(index, job))
+            {
+                Execute(job);
+            }
+            else
+            {
+                std::this_thread::yield(); // the last jobs are running on other threads
+            }
+        }
+    }
+
+    /// <summary>
+    /// Runs body(i) for every i in [0, count) on the pool and the calling thread, grain items per
+    /// job, and returns once all of them are done.
+    /// </summary>
+    template <typename Body>
+    void ParallelFor(size_t count, size_t grain, const Body &body)
+    {
+        JobCounter counter;
+        Dispatch(count, grain, &RunRange<Body>, const_cast<Body *>(&body), counter);
+        Wait(counter);
+    }
+
+    unsigned int GetWorkerCount() const
+    {
+        return WorkerCount;
+    }
+
+private:
+    unsigned int WorkerCount;
+    vector<JobQueue> Queues; // 0 for threads outside the pool, then one per worker
+    vector<std::thread> Workers;
+    std::atomic<int> QueuedJobs{0};
+    std::mutex SleepMutex;
+    std::condition_variable WakeUp;
+    bool Stopping = false;
+
+    // the system and queue of the current thread, only set on worker threads
+    static const JobSystem *&ThreadSystem()
+    {
+        thread_local const JobSystem *system = nullptr;
+        return system;
+    }
+
+    static size_t &ThreadQueueIndex()
+    {
+        thread_local size_t index = 0;
+        return index;
+    }
+
+    static unsigned int DefaultWorkerCount()
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+    template <typename Body>
+    static void RunRange(void *data, size_t begin, size_t end)
+    {
+        const Body &body = *static_cast<const Body *>(data);
+        for (size_t i = begin; i < end; ++i)
+        {
+            body(i);
+        }
+    }
+
+    size_t GetQueueIndex() const
+    {
+        return ThreadSystem() == this ? ThreadQueueIndex() : 0;
+    }
+
+    /// <summary>
+    /// Takes the newest job of the thread's own queue, or else the oldest job of another queue.
+    /// </summary>
+    bool FindJob(size_t index, Job &job)
+    {
+        bool found = Queues[index].Pop(job);
+        for (size_t i = 1; !found && i < Queues.size(); ++i)
+        {
+            found = Queues[(index + i) % Queues.size()].Steal(job);
+        }
+        if (found)
+        {
+            QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return found;
+    }
+
+    static void Execute(const Job &job)
+    {
+        job.Function(job.Data, job.Begin, job.End);
+        job.Counter->Pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    void WorkerLoop(size_t index)
+    {
+        ThreadSystem() = this;
+        ThreadQueueIndex() = index;
+        while (true)
+        {
+            Job job;
+            if (FindJob(index, job))
+            {
+                Execute(job);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(SleepMutex);
+            WakeUp.wait(lock, [this]() {
+                return Stopping || QueuedJobs.load(std::memory_order_acquire) > 0;
+            });
+            if (Stopping)
+            {
+                return;
+            }
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef LOD_SELECTOR_H
+#define LOD_SELECTOR_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <mesh.h>
+
+/// <summary>
+/// Picks the level of detail of a mesh from how large its bounding sphere appears on screen. The
+/// error of each level is scaled by the same factor as the sphere, and the coarsest level whose
+/// error stays within MaxPixelError pixels is drawn.
+/// </summary>
+struct LodSelector
+{
+public:
+    // how many pixels a level may be off before a finer one is needed
+    float MaxPixelError = 1.0f;
+
+    /// <summary>
+    /// Sets the camera for the following selections, call it whenever the camera or the viewport
+    /// changes.
+    /// </summary>
+    void SetCamera(const glm::mat4 &projection, const glm::mat4 &view, float viewportHeight)
+    {
+        View = view;
+        // a perspective projection divides by the distance, [1][1] is cot(fov / 2)
+        PixelScale = projection[1][1] * viewportHeight * 0.5f;
+    }
+
+    /// <summary>
+    /// Returns the radius in pixels of the mesh's bounding sphere when drawn with transform.
+    /// </summary>
+    float GetProjectedRadius(const Mesh &mesh, const glm::mat4 &transform) const
+    {
+        glm::vec3 center = glm::vec3(View * transform * glm::vec4(mesh.SphereCenter, 1.0f));
+        float radius = mesh.SphereRadius * GetMaxScale(transform);
+        float distance = glm::length(center);
+        if (distance <= radius)
+        {
+            return INFINITY; // the camera is inside the sphere
+        }
+        return radius * PixelScale / distance;
+    }
+
+    unsigned int Select(const Mesh &mesh, const glm::mat4 &transform) const
+    {
+        if (mesh.Lods.size() <= 1 || mesh.SphereRadius <= 0.0f)
+        {
+            return 0;
+        }
+
+        // errors are in object space like the sphere, so they shrink on screen at the same rate
+        float pixelsPerUnit = GetProjectedRadius(mesh, transform) / mesh.SphereRadius;
+        for (size_t lod = mesh.Lods.size() - 1; lod > 0; --lod)
+        {
+            if (mesh.Lods[lod].Error * pixelsPerUnit <= MaxPixelError)
+            {
+                return static_cast<unsigned int>(lod);
+            }
+        }
+        return 0;
+    }
+
+private:
+    glm::mat4 View = glm::mat4(1.0f);
+    float PixelScale = 0.0f;
+
+    static float GetMaxScale(const glm::mat4 &transform)
+    {
+        float x = glm::length(glm::vec3(transform[0]));
+        float y = glm::length(glm::vec3(transform[1]));
+        float z = glm::length(glm::vec3(transform[2]));
+        return std::max(x, std::max(y, z));
+    }
+};
+
+#endif
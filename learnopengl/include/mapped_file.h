@@ -0,0 +1,163 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef _WINDOWS_
+#undef APIENTRY
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+/// <summary>
+/// Read-only memory mapping of a whole file. The contents stay valid for as long as the object
+/// lives, so data can be used straight out of the page cache without copying or parsing it.
+/// </summary>
+struct MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const string &path)
+    {
+        Open(path);
+    }
+
+    ~MappedFile()
+    {
+        Close();
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /// <summary>
+    /// Maps the file at path, returns false if it doesn't exist or can't be mapped.
+    /// </summary>
+    bool Open(const string &path)
+    {
+        Close();
+#if defined(_WIN32)
+        FileHandle = CreateFileA(path.c_str(),
+                                 GENERIC_READ,
+                                 FILE_SHARE_READ,
+                                 NULL,
+                                 OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL,
+                                 NULL);
+        if (FileHandle == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(FileHandle, &fileSize) || fileSize.QuadPart == 0)
+        {
+            Close();
+            return false;
+        }
+        MappingHandle = CreateFileMappingA(FileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (MappingHandle == NULL)
+        {
+            Close();
+            return false;
+        }
+        Data = static_cast<const char *>(MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0));
+        Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        FileDescriptor = open(path.c_str(), O_RDONLY);
+        if (FileDescriptor < 0)
+        {
+            return false;
+        }
+        struct stat fileInfo;
+        if (fstat(FileDescriptor, &fileInfo) != 0 || fileInfo.st_size == 0)
+        {
+            Close();
+            return false;
+        }
+        void *mapping = mmap(NULL, fileInfo.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+        Data = mapping != MAP_FAILED ? static_cast<const char *>(mapping) : nullptr;
+        Size = static_cast<size_t>(fileInfo.st_size);
+#endif
+        if (Data == nullptr)
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+#if defined(_WIN32)
+        if (Data != nullptr)
+        {
+            UnmapViewOfFile(Data);
+        }
+        if (MappingHandle != NULL)
+        {
+            CloseHandle(MappingHandle);
+            MappingHandle = NULL;
+        }
+        if (FileHandle != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(FileHandle);
+            FileHandle = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (Data != nullptr)
+        {
+            munmap(const_cast<char *>(Data), Size);
+        }
+        if (FileDescriptor >= 0)
+        {
+            close(FileDescriptor);
+            FileDescriptor = -1;
+        }
+#endif
+        Data = nullptr;
+        Size = 0;
+    }
+
+    const char *GetData() const
+    {
+        return Data;
+    }
+
+    size_t GetSize() const
+    {
+        return Size;
+    }
+
+    bool IsOpen() const
+    {
+        return Data != nullptr;
+    }
+
+private:
+    const char *Data = nullptr;
+    size_t Size = 0;
+#if defined(_WIN32)
+    HANDLE FileHandle = INVALID_HANDLE_VALUE;
+    HANDLE MappingHandle = NULL;
+#else
+    int FileDescriptor = -1;
+#endif
+};
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <glad/glad.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <frame_stats.h>
+#include <shader.h>
+
+using std::string;
+using std::vector;
+
+struct Texture
+{
+    unsigned int ID;
+    string Type;
+    string Path;
+};
+
+/// <summary>
+/// One texture of a material: the unit it goes to, the texture and the sampler that reads it.
+/// </summary>
+struct MaterialBinding
+{
+    unsigned int Unit;
+    unsigned int TextureID;
+    unsigned int Sampler; // process wide sampler number, see MaterialRegistry::GetSamplerName
+};
+
+/// <summary>
+/// A set of textures resolved into a binding table once, so binding it needs no strings.
+/// </summary>
+struct Material
+{
+    vector<MaterialBinding> Bindings;
+};
+
+/// <summary>
+/// Hands out small process wide IDs for texture sets, so the render queue can sort and compare
+/// materials with a single integer. Meshes of any model that use the same textures in the same
+/// order get the same ID. ID 0 is the material without textures.
+///
+/// Sampler names (texture_diffuse1, texture_specular1, ...) are numbered here as well, each
+/// Shader then resolves a sampler number to its uniform location the first time it binds it.
+/// </summary>
+struct MaterialRegistry
+{
+public:
+    static MaterialRegistry &Get()
+    {
+        static MaterialRegistry instance;
+        return instance;
+    }
+
+    /// <summary>
+    /// Returns the ID of the texture set, registering it on first use.
+    /// </summary>
+    unsigned int Register(const vector<Texture> &textures)
+    {
+        Material material;
+        string key;
+        unsigned int diffuseNr = 1;
+        unsigned int specularNr = 1;
+        unsigned int normalNr = 1;
+        unsigned int heightNr = 1;
+        for (unsigned int i = 0; i < textures.size(); ++i)
+        {
+            // retrieve texture number (the N in texture_diffuseN)
+            const Texture &texture = textures[i];
+            string number;
+            if (texture.Type == "texture_diffuse")
+                number = std::to_string(diffuseNr++);
+            else if (texture.Type == "texture_specular")
+                number = std::to_string(specularNr++);
+            else if (texture.Type == "texture_normal")
+                number = std::to_string(normalNr++);
+            else if (texture.Type == "texture_height")
+                number = std::to_string(heightNr++);
+
+            unsigned int sampler = InternSampler(texture.Type + number);
+            material.Bindings.push_back(MaterialBinding{i, texture.ID, sampler});
+            key += std::to_string(texture.ID) + ":" + std::to_string(sampler) + ";";
+        }
+
+        auto it = IDs.find(key);
+        if (it != IDs.end())
+        {
+            return it->second;
+        }
+        unsigned int id = static_cast<unsigned int>(Materials.size());
+        Materials.push_back(material);
+        IDs.emplace(key, id);
+        return id;
+    }
+
+    const Material &GetMaterial(unsigned int id) const
+    {
+        return Materials[id];
+    }
+
+    size_t GetMaterialCount() const
+    {
+        return Materials.size();
+    }
+
+    const string &GetSamplerName(unsigned int sampler) const
+    {
+        return SamplerNames[sampler];
+    }
+
+    /// <summary>
+    /// Binds the textures of a material and points the shader's samplers at them, the shader has
+    /// to be in use. boundTextures, if given, holds the texture on each of the first unitCount
+    /// units and binds of a texture that is already there are skipped.
+    /// </summary>
+    void Bind(unsigned int id,
+              Shader &shader,
+              unsigned int *boundTextures = nullptr,
+              unsigned int unitCount = 0) const
+    {
+        for (const MaterialBinding &binding : Materials[id].Bindings)
+        {
+            shader.SetSampler(binding.Sampler, SamplerNames[binding.Sampler], binding.Unit);
+            if (boundTextures != nullptr && binding.Unit < unitCount)
+            {
+                if (boundTextures[binding.Unit] == binding.TextureID)
+                {
+                    continue;
+                }
+                boundTextures[binding.Unit] = binding.TextureID;
+            }
+            glActiveTexture(GL_TEXTURE0 + binding.Unit);
+            glBindTexture(GL_TEXTURE_2D, binding.TextureID);
+            ++frameStats.TextureBinds;
+        }
+    }
+
+private:
+    vector<Material> Materials;
+    std::unordered_map<string, unsigned int> IDs;
+    vector<string> SamplerNames;
+    std::unordered_map<string, unsigned int> SamplerNumbers;
+
+    MaterialRegistry()
+    {
+        Register(vector<Texture>()); // ID 0, no textures
+    }
+
+    unsigned int InternSampler(const string &name)
+    {
+        auto it = SamplerNumbers.find(name);
+        if (it != SamplerNumbers.end())
+        {
+            return it->second;
+        }
+        unsigned int sampler = static_cast<unsigned int>(SamplerNames.size());
+        SamplerNames.push_back(name);
+        SamplerNumbers.emplace(name, sampler);
+        return sampler;
+    }
+};
+
+#endif
@@ -5,36 +5,30 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <cmath>
 #include <vector>
 #include <string>
+#include <utility>
 
+#include <material.h>
+#include <meshlet.h>
 #include <shader.h>
+#include <vertex_format.h>
 
 using std::string;
 using std::vector;
 
-#define MAX_BONE_INFLUENCE 4
+// meshes with at most this many vertices use 16 bit indices
+const unsigned int MAX_SHORT_INDEX_VERTICES = 65536;
 
-struct Vertex
+/// <summary>
+/// One level of detail of a mesh: a range of its indices into the same vertices.
+/// </summary>
+struct MeshLod
 {
-    glm::vec3 Position;
-    glm::vec3 Normal;
-    glm::vec2 TexCoords;
-    glm::vec3 Tangent;
-    glm::vec3 Bitangent;
-
-    // bone indices which will influence this vertex
-    int BoneIDs[MAX_BONE_INFLUENCE];
-
-    // weights from each bone
-    float Weights[MAX_BONE_INFLUENCE];
-};
-
-struct Texture
-{
-    unsigned int ID;
-    string Type;
-    string Path;
+    unsigned int FirstIndex; // relative to the mesh's own first index
+    unsigned int IndexCount;
+    float Error; // how far the surface may be off from the full mesh, in object space units
 };
 
 struct Mesh
@@ -44,133 +38,155 @@ public:
     vector<Vertex> Vertices;
     vector<unsigned int> Indices;
     vector<Texture> Textures;
+    unsigned int MaterialIndex = 0; // index of the source material, shared by meshes that use it
+    unsigned int MaterialID = 0;    // process wide ID of the texture set, see MaterialRegistry
+    bool HasBones;                  // whether the source mesh has any bone influences
+    VertexLayout Layout;            // layout of the vertices in the model's vertex buffer
+
+    // what is known about the geometry even after the CPU copies are released
+    unsigned int VertexCount = 0;
+    unsigned int IndexCount = 0; // of all levels of detail together
+    vector<MeshLod> Lods;        // finest first, Lods[0] is the full mesh
+    vector<Meshlet> Meshlets;    // clusters of Lods[0], empty unless they were built
+    GLenum IndexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT whenever the vertex count allows
+    glm::vec3 BoundsMin = glm::vec3(0.0f); // object space bounding box
+    glm::vec3 BoundsMax = glm::vec3(0.0f);
+    glm::vec3 SphereCenter = glm::vec3(0.0f); // object space bounding sphere around the box center
+    float SphereRadius = 0.0f;
+
+    // range of the mesh inside the model's shared buffers, filled in by ModelGeometry
+    int BaseVertex = 0;          // added to every index by glDrawElementsBaseVertex
+    unsigned int FirstIndex = 0; // offset into the index buffer in indices of IndexType
+
+    /// <summary>
+    /// Takes over the given buffers, pass them with std::move to avoid copying the vertex data.
+    /// Nothing is uploaded here, the model packs all its meshes into one set of buffers.
+    /// </summary>
+    Mesh(vector<Vertex> vertices,
+         vector<unsigned int> indices,
+         vector<Texture> textures,
+         bool hasBones = true)
+        : Vertices(std::move(vertices)),
+          Indices(std::move(indices)),
+          Textures(std::move(textures)),
+          HasBones(hasBones)
+    {
+        VertexCount = static_cast<unsigned int>(Vertices.size());
+        IndexCount = static_cast<unsigned int>(Indices.size());
+        Lods.push_back(MeshLod{0, IndexCount, 0.0f});
+        // indices are relative to the mesh's own vertices, so only its vertex count matters
+        IndexType = VertexCount <= MAX_SHORT_INDEX_VERTICES ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        MaterialID = MaterialRegistry::Get().Register(Textures);
+        ComputeBounds();
+    }
+
+    /// <summary>
+    /// Size of the vertex data on the GPU in bytes.
+    /// </summary>
+    size_t GetVertexBufferSize() const
+    {
+        return static_cast<size_t>(VertexCount) * Layout.Stride;
+    }
 
-    unsigned int VAO; // Vertex Array Object made public for.....some reason...?
+    /// <summary>
+    /// Size of the index data on the GPU in bytes.
+    /// </summary>
+    size_t GetIndexBufferSize() const
+    {
+        return static_cast<size_t>(IndexCount) * GetIndexSize();
+    }
 
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    /// <summary>
+    /// Size of a single index on the GPU in bytes.
+    /// </summary>
+    size_t GetIndexSize() const
     {
-        this->Vertices = vertices;
-        this->Indices = indices;
-        this->Textures = textures;
+        return IndexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+    }
 
-        Setup();
+    /// <summary>
+    /// Size of the vertex and index data kept in system memory in bytes.
+    /// </summary>
+    size_t GetCpuGeometrySize() const
+    {
+        return Vertices.capacity() * sizeof(Vertex) + Indices.capacity() * sizeof(unsigned int);
     }
 
-    void Draw(Shader &shader)
+    /// <summary>
+    /// Frees the CPU copies of the vertices and indices. The GPU buffers, counts and bounds stay,
+    /// so the mesh can still be drawn, only CPU side consumers like picking lose their data.
+    /// </summary>
+    void ReleaseCpuGeometry()
     {
-        // bind appropriate textures
-        unsigned int diffuseNr = 1;
-        unsigned int specularNr = 1;
-        unsigned int normalNr = 1;
-        unsigned int heightNr = 1;
-        for (unsigned int i = 0; i < Textures.size(); i++)
-        {
-            glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
-            // retrieve texture number (the N in diffuse_textureN)
-            string number;
-            string name = Textures[i].Type;
-            if (name == "texture_diffuse")
-                number = std::to_string(diffuseNr++);
-            else if (name == "texture_specular")
-                number = std::to_string(specularNr++); // transfer unsigned int to string
-            else if (name == "texture_normal")
-                number = std::to_string(normalNr++); // transfer unsigned int to string
-            else if (name == "texture_height")
-                number = std::to_string(heightNr++); // transfer unsigned int to string
-
-            // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
-            // and finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, Textures[i].ID);
-        }
+        vector<Vertex>().swap(Vertices);
+        vector<unsigned int>().swap(Indices);
+    }
 
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(Indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    /// <summary>
+    /// Binds the textures and draws a level of detail of the mesh. The model's vertex array has to
+    /// be bound already.
+    /// </summary>
+    void Draw(Shader &shader, unsigned int lod = 0)
+    {
+        // the binding table was resolved when the mesh was created, no names are built here
+        MaterialRegistry::Get().Bind(MaterialID, shader);
+        DrawRange(lod);
 
         // always good practice to set everything back to defaults once configured.
         glActiveTexture(GL_TEXTURE0);
     }
 
-private:
-    unsigned int VBO; // Vertex Buffer Object
-    unsigned int EBO; // Element Buffer Object
+    /// <summary>
+    /// Draws a level of detail from the mesh's range of the shared buffers with whatever textures
+    /// are bound.
+    /// </summary>
+    void DrawRange(unsigned int lod = 0) const
+    {
+        const MeshLod &range = Lods[lod];
+        size_t offset = (FirstIndex + range.FirstIndex) * GetIndexSize();
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES, range.IndexCount, IndexType, (void *)offset, BaseVertex);
+        ++frameStats.DrawCalls;
+        frameStats.TrianglesDrawn += range.IndexCount / 3;
+    }
+
+    /// <summary>
+    /// Draws a level of detail once per instance, the instance attributes have to be set up.
+    /// </summary>
+    void DrawInstancedRange(unsigned int instanceCount, unsigned int lod = 0) const
+    {
+        const MeshLod &range = Lods[lod];
+        size_t offset = (FirstIndex + range.FirstIndex) * GetIndexSize();
+        glDrawElementsInstancedBaseVertex(
+            GL_TRIANGLES, range.IndexCount, IndexType, (void *)offset, instanceCount, BaseVertex);
+        ++frameStats.DrawCalls;
+        frameStats.TrianglesDrawn += static_cast<unsigned long long>(range.IndexCount / 3) *
+                                     instanceCount;
+    }
 
-    void Setup()
+private:
+    void ComputeBounds()
     {
-        // create buffers/arrays
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        // load data into vertex buffers
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        // A great thing about structs is that their memory layout is sequential for all its items.
-        // The effect is that we can simply pass a pointer to the struct and it translates perfectly
-        // to a glm::vec3/2 array which again translates to 3/2 floats which translates to a byte
-        // array.
-        glBufferData(GL_ARRAY_BUFFER,
-                     Vertices.size() * sizeof(Vertex),
-                     &Vertices[0],
-                     GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-                     Indices.size() * sizeof(unsigned int),
-                     &Indices[0],
-                     GL_STATIC_DRAW);
-
-        // set the vertex attribute pointers
-        // vertex Positions
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-        // vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1,
-                              3,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (void *)offsetof(Vertex, Normal));
-        // vertex texture coords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2,
-                              2,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (void *)offsetof(Vertex, TexCoords));
-        // vertex tangent
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3,
-                              3,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (void *)offsetof(Vertex, Tangent));
-        // vertex bitangent
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4,
-                              3,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (void *)offsetof(Vertex, Bitangent));
-        // ids
-        glEnableVertexAttribArray(5);
-        glVertexAttribIPointer(5, 4, GL_INT, sizeof(Vertex), (void *)offsetof(Vertex, BoneIDs));
-
-        // weights
-        glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6,
-                              4,
-                              GL_FLOAT,
-                              GL_FALSE,
-                              sizeof(Vertex),
-                              (void *)offsetof(Vertex, Weights));
-        glBindVertexArray(0);
+        if (Vertices.empty())
+        {
+            return;
+        }
+        BoundsMin = BoundsMax = Vertices[0].Position;
+        for (const Vertex &vertex : Vertices)
+        {
+            BoundsMin = glm::min(BoundsMin, vertex.Position);
+            BoundsMax = glm::max(BoundsMax, vertex.Position);
+        }
+
+        // centered on the box, but only as large as the farthest vertex needs
+        SphereCenter = (BoundsMin + BoundsMax) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (const Vertex &vertex : Vertices)
+        {
+            glm::vec3 offset = vertex.Position - SphereCenter;
+            radiusSquared = glm::max(radiusSquared, glm::dot(offset, offset));
+        }
+        SphereRadius = std::sqrt(radiusSquared);
     }
 };
 
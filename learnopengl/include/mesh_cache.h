@@ -0,0 +1,673 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <mapped_file.h>
+#include <mesh.h>
+
+using std::string;
+using std::vector;
+
+// Bump whenever the layout of the file or of Vertex changes, old caches are then rebuilt.
+const uint32_t MESH_CACHE_VERSION = 7;
+const char MESH_CACHE_MAGIC[8] = {'L', 'O', 'G', 'L', 'M', 'E', 'S', 'H'};
+const char *const MESH_CACHE_EXTENSION = ".meshcache";
+
+// The cache file is a header followed by fixed size tables and raw blobs. Everything is addressed
+// by byte offsets from the start of the file and the blobs are 16 byte aligned, so a mapped file
+// is read in place without parsing. Vertices and indices are stored as full Vertex structs and
+// 32 bit indices, each mesh copies its range out of the mapping once; ModelGeometry::Upload then
+// converts them to the vertex format and index size the model was loaded with.
+//
+// [header][dependencies][meshes][lods][meshlets][materials][textures][nodes][node meshes][bones]
+// [strings][vertices][indices]
+
+struct MeshCacheHeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t VertexSize;  // sizeof(Vertex) of the build that wrote the file
+    uint64_t SourceHash;  // FNV-1a of the source asset
+    uint32_t ImportFlags;     // assimp post processing flags used for the import
+    uint32_t ProcessingFlags; // MESH_CACHE_PROCESS_* steps run on the imported meshes
+    uint32_t MeshCount;
+    uint32_t LodCount;
+    uint32_t MeshletCount;
+    uint32_t MaterialCount;
+    uint32_t TextureCount;
+    uint32_t NodeCount;
+    uint32_t NodeMeshCount;
+    uint32_t BoneCount;
+    uint32_t DependencyCount;
+    uint32_t Padding;
+    uint64_t DependenciesOffset;
+    uint64_t MeshesOffset;
+    uint64_t LodsOffset;
+    uint64_t MeshletsOffset;
+    uint64_t MaterialsOffset;
+    uint64_t TexturesOffset;
+    uint64_t NodesOffset;
+    uint64_t NodeMeshesOffset;
+    uint64_t BonesOffset;
+    uint64_t StringsOffset;
+    uint64_t VerticesOffset;
+    uint64_t IndicesOffset;
+    uint64_t FileSize;
+};
+
+// a file the import read besides the source asset, e.g. the material library of an .obj
+struct MeshCacheDependency
+{
+    uint64_t Hash; // FNV-1a of the contents
+    uint32_t PathOffset; // into the string blob
+    uint32_t PathLength;
+};
+
+struct MeshCacheMesh
+{
+    uint64_t FirstVertex; // in vertices from the start of the vertex blob
+    uint64_t FirstIndex;  // in indices from the start of the index blob
+    uint32_t VertexCount;
+    uint32_t IndexCount;
+    uint32_t MaterialIndex;
+    uint32_t Flags;        // MESH_CACHE_FLAG_*
+    uint32_t FirstLod;     // into the lod table
+    uint32_t LodCount;
+    uint32_t FirstMeshlet; // into the meshlet table
+    uint32_t MeshletCount;
+};
+
+struct MeshCacheLod
+{
+    uint32_t FirstIndex; // relative to the mesh's first index
+    uint32_t IndexCount;
+    float Error;
+    uint32_t Padding;
+};
+
+struct MeshCacheMeshlet
+{
+    uint32_t FirstIndex; // relative to the mesh's first index
+    uint32_t IndexCount;
+    float Center[3];
+    float Radius;
+    float ConeAxis[3];
+    float ConeCutoff;
+    uint32_t Padding[2];
+};
+
+const uint32_t MESH_CACHE_FLAG_HAS_BONES = 1u << 0;
+
+// processing done after the import, a cache written with different steps is rebuilt
+const uint32_t MESH_CACHE_PROCESS_OPTIMIZED = 1u << 0;
+const uint32_t MESH_CACHE_PROCESS_LODS = 1u << 1;
+const uint32_t MESH_CACHE_PROCESS_MESHLETS = 1u << 2;
+
+struct MeshCacheMaterial
+{
+    uint32_t FirstTexture;
+    uint32_t TextureCount;
+};
+
+struct MeshCacheTexture
+{
+    uint32_t TypeOffset; // into the string blob
+    uint32_t TypeLength;
+    uint32_t PathOffset;
+    uint32_t PathLength;
+};
+
+struct MeshCacheNode
+{
+    float Transform[16]; // column major, relative to the parent
+    int32_t Parent;      // -1 for the root, parents always come before their children
+    uint32_t NameOffset;
+    uint32_t NameLength;
+    uint32_t FirstMesh; // into the node mesh table
+    uint32_t MeshCount;
+    uint32_t Padding[3];
+};
+
+struct MeshCacheBone
+{
+    float Offset[16]; // column major, mesh space to bone space
+    uint32_t NameOffset;
+    uint32_t NameLength;
+    uint32_t Padding[2];
+};
+
+/// <summary>
+/// Hashes a file with 64 bit FNV-1a, returns false if it can't be read.
+/// </summary>
+inline bool HashFile(const string &path, uint64_t &hash)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+
+    hash = 14695981039346656037ull;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(file.GetData());
+    for (size_t i = 0; i < file.GetSize(); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return true;
+}
+
+/// <summary>
+/// Maps a cache file and exposes its tables. Open() rejects the file unless it was written by this
+/// version for the same source contents, import flags and processing steps, and every other file
+/// the import read still has the contents it had then.
+/// </summary>
+struct MeshCacheReader
+{
+public:
+    bool Open(const string &path,
+              uint64_t sourceHash,
+              uint32_t importFlags,
+              uint32_t processingFlags)
+    {
+        if (!File.Open(path) || File.GetSize() < sizeof(MeshCacheHeader))
+        {
+            return false;
+        }
+
+        Header = reinterpret_cast<const MeshCacheHeader *>(File.GetData());
+        if (std::memcmp(Header->Magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 ||
+            Header->Version != MESH_CACHE_VERSION || Header->VertexSize != sizeof(Vertex) ||
+            Header->SourceHash != sourceHash || Header->ImportFlags != importFlags ||
+            Header->ProcessingFlags != processingFlags || Header->FileSize != File.GetSize() ||
+            !CheckTables())
+        {
+            File.Close();
+            Header = nullptr;
+            return false;
+        }
+
+        for (uint32_t i = 0; i < Header->DependencyCount; ++i)
+        {
+            const MeshCacheDependency &dependency =
+                At<MeshCacheDependency>(Header->DependenciesOffset)[i];
+            uint64_t hash = 0;
+            if (!CheckString(dependency.PathOffset, dependency.PathLength) ||
+                !HashFile(GetString(dependency.PathOffset, dependency.PathLength), hash) ||
+                hash != dependency.Hash)
+            {
+                File.Close();
+                Header = nullptr;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const MeshCacheHeader &GetHeader() const
+    {
+        return *Header;
+    }
+
+    const MeshCacheMesh &GetMesh(unsigned int index) const
+    {
+        return At<MeshCacheMesh>(Header->MeshesOffset)[index];
+    }
+
+    const MeshCacheLod *GetLods(const MeshCacheMesh &mesh) const
+    {
+        return At<MeshCacheLod>(Header->LodsOffset) + mesh.FirstLod;
+    }
+
+    const MeshCacheMeshlet *GetMeshlets(const MeshCacheMesh &mesh) const
+    {
+        return At<MeshCacheMeshlet>(Header->MeshletsOffset) + mesh.FirstMeshlet;
+    }
+
+    const MeshCacheMaterial &GetMaterial(unsigned int index) const
+    {
+        return At<MeshCacheMaterial>(Header->MaterialsOffset)[index];
+    }
+
+    const MeshCacheTexture &GetTexture(unsigned int index) const
+    {
+        return At<MeshCacheTexture>(Header->TexturesOffset)[index];
+    }
+
+    const MeshCacheNode &GetNode(unsigned int index) const
+    {
+        return At<MeshCacheNode>(Header->NodesOffset)[index];
+    }
+
+    const uint32_t *GetNodeMeshes(const MeshCacheNode &node) const
+    {
+        return At<uint32_t>(Header->NodeMeshesOffset) + node.FirstMesh;
+    }
+
+    const MeshCacheBone &GetBone(unsigned int index) const
+    {
+        return At<MeshCacheBone>(Header->BonesOffset)[index];
+    }
+
+    const Vertex *GetVertices(const MeshCacheMesh &mesh) const
+    {
+        return At<Vertex>(Header->VerticesOffset) + mesh.FirstVertex;
+    }
+
+    const unsigned int *GetIndices(const MeshCacheMesh &mesh) const
+    {
+        return At<unsigned int>(Header->IndicesOffset) + mesh.FirstIndex;
+    }
+
+    string GetString(uint32_t offset, uint32_t length) const
+    {
+        return string(At<char>(Header->StringsOffset) + offset, length);
+    }
+
+    // Open only checks that the tables lie within the file, the entries in them are checked by
+    // the functions below before anything they point at is read
+
+    /// <summary>
+    /// Returns true if the vertices, indices, lods, meshlets and material of mesh are in the file.
+    /// </summary>
+    bool CheckMesh(const MeshCacheMesh &mesh) const
+    {
+        uint64_t vertexCapacity = (Header->IndicesOffset - Header->VerticesOffset) / sizeof(Vertex);
+        uint64_t indexCapacity = (Header->FileSize - Header->IndicesOffset) / sizeof(unsigned int);
+        if (!InRange(mesh.FirstVertex, mesh.VertexCount, vertexCapacity) ||
+            !InRange(mesh.FirstIndex, mesh.IndexCount, indexCapacity) ||
+            !InRange(mesh.FirstLod, mesh.LodCount, Header->LodCount) ||
+            !InRange(mesh.FirstMeshlet, mesh.MeshletCount, Header->MeshletCount) ||
+            mesh.MaterialIndex >= Header->MaterialCount)
+        {
+            return false;
+        }
+        const MeshCacheLod *lods = GetLods(mesh);
+        for (uint32_t i = 0; i < mesh.LodCount; ++i)
+        {
+            if (!InRange(lods[i].FirstIndex, lods[i].IndexCount, mesh.IndexCount))
+            {
+                return false;
+            }
+        }
+        const MeshCacheMeshlet *meshlets = GetMeshlets(mesh);
+        for (uint32_t i = 0; i < mesh.MeshletCount; ++i)
+        {
+            if (!InRange(meshlets[i].FirstIndex, meshlets[i].IndexCount, mesh.IndexCount))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CheckMaterial(const MeshCacheMaterial &material) const
+    {
+        return InRange(material.FirstTexture, material.TextureCount, Header->TextureCount);
+    }
+
+    bool CheckTexture(const MeshCacheTexture &texture) const
+    {
+        return CheckString(texture.TypeOffset, texture.TypeLength) &&
+               CheckString(texture.PathOffset, texture.PathLength);
+    }
+
+    /// <summary>
+    /// Returns true if the node at index has a parent before it, or none, and its name and meshes
+    /// are in the file.
+    /// </summary>
+    bool CheckNode(const MeshCacheNode &node, unsigned int index) const
+    {
+        if (node.Parent < -1 || node.Parent >= static_cast<int64_t>(index) ||
+            !CheckString(node.NameOffset, node.NameLength) ||
+            !InRange(node.FirstMesh, node.MeshCount, Header->NodeMeshCount))
+        {
+            return false;
+        }
+        const uint32_t *meshes = GetNodeMeshes(node);
+        for (uint32_t i = 0; i < node.MeshCount; ++i)
+        {
+            if (meshes[i] >= Header->MeshCount)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CheckBone(const MeshCacheBone &bone) const
+    {
+        return CheckString(bone.NameOffset, bone.NameLength);
+    }
+
+    bool CheckString(uint32_t offset, uint32_t length) const
+    {
+        return InRange(offset, length, Header->VerticesOffset - Header->StringsOffset);
+    }
+
+private:
+    MappedFile File;
+    const MeshCacheHeader *Header = nullptr;
+
+    /// <summary>
+    /// Returns true if every table and blob lies within the file, in the order Save writes them,
+    /// at offsets aligned as Save aligns them.
+    /// </summary>
+    bool CheckTables() const
+    {
+        struct Table
+        {
+            uint64_t Offset;
+            uint64_t Count;
+            uint64_t ElementSize;
+        };
+        const Table tables[] = {
+            {Header->DependenciesOffset, Header->DependencyCount, sizeof(MeshCacheDependency)},
+            {Header->MeshesOffset, Header->MeshCount, sizeof(MeshCacheMesh)},
+            {Header->LodsOffset, Header->LodCount, sizeof(MeshCacheLod)},
+            {Header->MeshletsOffset, Header->MeshletCount, sizeof(MeshCacheMeshlet)},
+            {Header->MaterialsOffset, Header->MaterialCount, sizeof(MeshCacheMaterial)},
+            {Header->TexturesOffset, Header->TextureCount, sizeof(MeshCacheTexture)},
+            {Header->NodesOffset, Header->NodeCount, sizeof(MeshCacheNode)},
+            {Header->NodeMeshesOffset, Header->NodeMeshCount, sizeof(uint32_t)},
+            {Header->BonesOffset, Header->BoneCount, sizeof(MeshCacheBone)},
+            // the strings and the two blobs fill everything up to the next one
+            {Header->StringsOffset, 0, 0},
+            {Header->VerticesOffset, 0, 0},
+            {Header->IndicesOffset, 0, 0},
+        };
+        uint64_t end = sizeof(MeshCacheHeader);
+        for (const Table &table : tables)
+        {
+            uint64_t size = table.Count * table.ElementSize; // counts are 32 bit, can't overflow
+            if (table.Offset % 16 != 0 || table.Offset < end ||
+                !InRange(table.Offset, size, Header->FileSize))
+            {
+                return false;
+            }
+            end = table.Offset + size;
+        }
+        return true;
+    }
+
+    static bool InRange(uint64_t first, uint64_t count, uint64_t size)
+    {
+        return first <= size && count <= size - first;
+    }
+
+    template <typename T>
+    const T *At(uint64_t offset) const
+    {
+        return reinterpret_cast<const T *>(File.GetData() + offset);
+    }
+};
+
+/// <summary>
+/// Collects the processed data of a model and writes it out as a cache file. Only references to
+/// the vertex and index data are kept, so they have to outlive the call to Save().
+/// </summary>
+struct MeshCacheWriter
+{
+public:
+    /// <summary>
+    /// Records a file the import read besides the source asset, the cache is stale once it
+    /// changes.
+    /// </summary>
+    void AddDependency(const string &path, uint64_t hash)
+    {
+        MeshCacheDependency dependency;
+        dependency.Hash = hash;
+        dependency.PathOffset = AddString(path);
+        dependency.PathLength = static_cast<uint32_t>(path.size());
+        Dependencies.push_back(dependency);
+    }
+
+    void AddMesh(const vector<Vertex> &vertices,
+                 const vector<unsigned int> &indices,
+                 const vector<MeshLod> &lods,
+                 const vector<Meshlet> &meshlets,
+                 uint32_t materialIndex,
+                 uint32_t flags)
+    {
+        MeshCacheMesh mesh = {};
+        mesh.FirstVertex = VertexCount;
+        mesh.FirstIndex = IndexCount;
+        mesh.VertexCount = static_cast<uint32_t>(vertices.size());
+        mesh.IndexCount = static_cast<uint32_t>(indices.size());
+        mesh.MaterialIndex = materialIndex;
+        mesh.Flags = flags;
+        mesh.FirstLod = static_cast<uint32_t>(Lods.size());
+        mesh.LodCount = static_cast<uint32_t>(lods.size());
+        for (const MeshLod &lod : lods)
+        {
+            Lods.push_back(MeshCacheLod{lod.FirstIndex, lod.IndexCount, lod.Error, 0});
+        }
+        mesh.FirstMeshlet = static_cast<uint32_t>(Meshlets.size());
+        mesh.MeshletCount = static_cast<uint32_t>(meshlets.size());
+        for (const Meshlet &meshlet : meshlets)
+        {
+            MeshCacheMeshlet entry = {};
+            entry.FirstIndex = meshlet.FirstIndex;
+            entry.IndexCount = meshlet.IndexCount;
+            std::memcpy(entry.Center, &meshlet.Center[0], sizeof(entry.Center));
+            entry.Radius = meshlet.Radius;
+            std::memcpy(entry.ConeAxis, &meshlet.ConeAxis[0], sizeof(entry.ConeAxis));
+            entry.ConeCutoff = meshlet.ConeCutoff;
+            Meshlets.push_back(entry);
+        }
+        Meshes.push_back(mesh);
+        VertexBlobs.push_back(&vertices);
+        IndexBlobs.push_back(&indices);
+
+        VertexCount += vertices.size();
+        IndexCount += indices.size();
+    }
+
+    /// <summary>
+    /// Records the textures of a material the first time it is seen, gaps are filled with empty
+    /// materials.
+    /// </summary>
+    void SetMaterial(uint32_t index, const vector<Texture> &textures)
+    {
+        if (index >= Materials.size())
+        {
+            Materials.resize(index + 1, MeshCacheMaterial{0, 0});
+            MaterialsSet.resize(index + 1, false);
+        }
+        if (MaterialsSet[index])
+        {
+            return;
+        }
+        MaterialsSet[index] = true;
+
+        MeshCacheMaterial &material = Materials[index];
+        material.FirstTexture = static_cast<uint32_t>(Textures.size());
+        material.TextureCount = static_cast<uint32_t>(textures.size());
+        for (const Texture &texture : textures)
+        {
+            MeshCacheTexture entry;
+            entry.TypeOffset = AddString(texture.Type);
+            entry.TypeLength = static_cast<uint32_t>(texture.Type.size());
+            entry.PathOffset = AddString(texture.Path);
+            entry.PathLength = static_cast<uint32_t>(texture.Path.size());
+            Textures.push_back(entry);
+        }
+    }
+
+    void AddNode(const string &name,
+                 int32_t parent,
+                 const glm::mat4 &transform,
+                 const vector<unsigned int> &meshIndices)
+    {
+        MeshCacheNode node = {};
+        std::memcpy(node.Transform, &transform[0][0], sizeof(node.Transform));
+        node.Parent = parent;
+        node.NameOffset = AddString(name);
+        node.NameLength = static_cast<uint32_t>(name.size());
+        node.FirstMesh = static_cast<uint32_t>(NodeMeshes.size());
+        node.MeshCount = static_cast<uint32_t>(meshIndices.size());
+        NodeMeshes.insert(NodeMeshes.end(), meshIndices.begin(), meshIndices.end());
+        Nodes.push_back(node);
+    }
+
+    /// <summary>
+    /// Appends a bone, bones have to be added in ID order.
+    /// </summary>
+    void AddBone(const string &name, const glm::mat4 &offset)
+    {
+        MeshCacheBone bone = {};
+        std::memcpy(bone.Offset, &offset[0][0], sizeof(bone.Offset));
+        bone.NameOffset = AddString(name);
+        bone.NameLength = static_cast<uint32_t>(name.size());
+        Bones.push_back(bone);
+    }
+
+    bool Save(const string &path,
+              uint64_t sourceHash,
+              uint32_t importFlags,
+              uint32_t processingFlags) const
+    {
+        MeshCacheHeader header = {};
+        std::memcpy(header.Magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+        header.Version = MESH_CACHE_VERSION;
+        header.VertexSize = sizeof(Vertex);
+        header.SourceHash = sourceHash;
+        header.ImportFlags = importFlags;
+        header.ProcessingFlags = processingFlags;
+        header.MeshCount = static_cast<uint32_t>(Meshes.size());
+        header.LodCount = static_cast<uint32_t>(Lods.size());
+        header.MeshletCount = static_cast<uint32_t>(Meshlets.size());
+        header.MaterialCount = static_cast<uint32_t>(Materials.size());
+        header.TextureCount = static_cast<uint32_t>(Textures.size());
+        header.NodeCount = static_cast<uint32_t>(Nodes.size());
+        header.NodeMeshCount = static_cast<uint32_t>(NodeMeshes.size());
+        header.BoneCount = static_cast<uint32_t>(Bones.size());
+        header.DependencyCount = static_cast<uint32_t>(Dependencies.size());
+
+        uint64_t offset = Align(sizeof(MeshCacheHeader));
+        header.DependenciesOffset = offset;
+        offset = Align(offset + Dependencies.size() * sizeof(MeshCacheDependency));
+        header.MeshesOffset = offset;
+        offset = Align(offset + Meshes.size() * sizeof(MeshCacheMesh));
+        header.LodsOffset = offset;
+        offset = Align(offset + Lods.size() * sizeof(MeshCacheLod));
+        header.MeshletsOffset = offset;
+        offset = Align(offset + Meshlets.size() * sizeof(MeshCacheMeshlet));
+        header.MaterialsOffset = offset;
+        offset = Align(offset + Materials.size() * sizeof(MeshCacheMaterial));
+        header.TexturesOffset = offset;
+        offset = Align(offset + Textures.size() * sizeof(MeshCacheTexture));
+        header.NodesOffset = offset;
+        offset = Align(offset + Nodes.size() * sizeof(MeshCacheNode));
+        header.NodeMeshesOffset = offset;
+        offset = Align(offset + NodeMeshes.size() * sizeof(uint32_t));
+        header.BonesOffset = offset;
+        offset = Align(offset + Bones.size() * sizeof(MeshCacheBone));
+        header.StringsOffset = offset;
+        offset = Align(offset + Strings.size());
+        header.VerticesOffset = offset;
+        offset = Align(offset + VertexCount * sizeof(Vertex));
+        header.IndicesOffset = offset;
+        header.FileSize = offset + IndexCount * sizeof(unsigned int);
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        uint64_t written = 0;
+        WriteAt(file, written, 0, &header, sizeof(header));
+        WriteAt(file,
+                written,
+                header.DependenciesOffset,
+                Dependencies.data(),
+                ByteSize(Dependencies));
+        WriteAt(file, written, header.MeshesOffset, Meshes.data(), ByteSize(Meshes));
+        WriteAt(file, written, header.LodsOffset, Lods.data(), ByteSize(Lods));
+        WriteAt(file, written, header.MeshletsOffset, Meshlets.data(), ByteSize(Meshlets));
+        WriteAt(file, written, header.MaterialsOffset, Materials.data(), ByteSize(Materials));
+        WriteAt(file, written, header.TexturesOffset, Textures.data(), ByteSize(Textures));
+        WriteAt(file, written, header.NodesOffset, Nodes.data(), ByteSize(Nodes));
+        WriteAt(file, written, header.NodeMeshesOffset, NodeMeshes.data(), ByteSize(NodeMeshes));
+        WriteAt(file, written, header.BonesOffset, Bones.data(), ByteSize(Bones));
+        WriteAt(file, written, header.StringsOffset, Strings.data(), Strings.size());
+        WriteAt(file, written, header.VerticesOffset, nullptr, 0);
+        for (const vector<Vertex> *vertices : VertexBlobs)
+        {
+            WriteAt(file, written, written, vertices->data(), ByteSize(*vertices));
+        }
+        WriteAt(file, written, header.IndicesOffset, nullptr, 0);
+        for (const vector<unsigned int> *indices : IndexBlobs)
+        {
+            WriteAt(file, written, written, indices->data(), ByteSize(*indices));
+        }
+        return static_cast<bool>(file);
+    }
+
+private:
+    vector<MeshCacheDependency> Dependencies;
+    vector<MeshCacheMesh> Meshes;
+    vector<MeshCacheLod> Lods;
+    vector<MeshCacheMeshlet> Meshlets;
+    vector<MeshCacheMaterial> Materials;
+    vector<bool> MaterialsSet;
+    vector<MeshCacheTexture> Textures;
+    vector<MeshCacheNode> Nodes;
+    vector<uint32_t> NodeMeshes;
+    vector<MeshCacheBone> Bones;
+    string Strings;
+    vector<const vector<Vertex> *> VertexBlobs;
+    vector<const vector<unsigned int> *> IndexBlobs;
+    uint64_t VertexCount = 0;
+    uint64_t IndexCount = 0;
+
+    uint32_t AddString(const string &value)
+    {
+        uint32_t offset = static_cast<uint32_t>(Strings.size());
+        Strings += value;
+        return offset;
+    }
+
+    template <typename T>
+    static size_t ByteSize(const vector<T> &values)
+    {
+        return values.size() * sizeof(T);
+    }
+
+    static uint64_t Align(uint64_t offset)
+    {
+        return (offset + 15) & ~uint64_t(15);
+    }
+
+    /// <summary>
+    /// Pads the stream with zeroes up to offset, then writes size bytes of data.
+    /// </summary>
+    static void WriteAt(
+        std::ofstream &file, uint64_t &written, uint64_t offset, const void *data, size_t size)
+    {
+        static const char zeroes[16] = {};
+        while (written < offset)
+        {
+            size_t padding =
+                static_cast<size_t>(std::min<uint64_t>(offset - written, sizeof(zeroes)));
+            file.write(zeroes, padding);
+            written += padding;
+        }
+        if (size > 0)
+        {
+            file.write(static_cast<const char *>(data), size);
+            written += size;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,475 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <vertex_format.h>
+
+using std::vector;
+
+// Import time reordering of mesh data for the GPU, run in three passes:
+//
+// 1. OptimizeVertexCache reorders triangles so vertices are reused while they are still in the
+//    post-transform cache (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation").
+// 2. OptimizeOverdraw splits that order into clusters at points where the cache order can be
+//    broken cheaply and sorts the clusters so outward facing ones come first, which lets early
+//    depth testing reject more of the rest (after Sander et al., "Fast Triangle Reordering for
+//    Vertex Locality and Reduced Overdraw").
+// 3. OptimizeVertexFetch renumbers vertices in the order they are first used, so vertex fetches
+//    walk the buffer front to back.
+//
+// The passes only reorder, the rendered result stays the same.
+
+// FIFO cache size used to measure the result, conservative for current hardware
+const unsigned int VERTEX_CACHE_SIZE = 16;
+// LRU cache size the Forsyth scoring is tuned for
+const unsigned int FORSYTH_CACHE_SIZE = 32;
+// how much worse than the cache optimized order a cluster may get before it is split off
+const float OVERDRAW_THRESHOLD = 1.05f;
+
+/// <summary>
+/// Post-transform cache efficiency of an index buffer, measured with a FIFO cache.
+/// </summary>
+struct VertexCacheStats
+{
+    size_t Triangles = 0;
+    size_t TransformedVertices = 0; // cache misses
+    size_t UniqueVertices = 0;      // vertices referenced by the indices
+
+    // average cache miss ratio, transformed vertices per triangle: 0.5 is ideal, 3 is worst
+    float GetACMR() const
+    {
+        return Triangles > 0 ? static_cast<float>(TransformedVertices) / Triangles : 0.0f;
+    }
+
+    // average transform to vertex ratio: 1 is ideal
+    float GetATVR() const
+    {
+        return UniqueVertices > 0 ? static_cast<float>(TransformedVertices) / UniqueVertices : 0.0f;
+    }
+
+    void Add(const VertexCacheStats &other)
+    {
+        Triangles += other.Triangles;
+        TransformedVertices += other.TransformedVertices;
+        UniqueVertices += other.UniqueVertices;
+    }
+};
+
+/// <summary>
+/// Runs the indices through a simulated FIFO cache of the given size.
+/// </summary>
+inline VertexCacheStats AnalyzeVertexCache(const vector<unsigned int> &indices,
+                                           size_t vertexCount,
+                                           unsigned int cacheSize = VERTEX_CACHE_SIZE)
+{
+    VertexCacheStats stats;
+    stats.Triangles = indices.size() / 3;
+
+    // a vertex is in the cache while fewer than cacheSize misses happened since it was loaded
+    vector<size_t> loadedAt(vertexCount, 0);
+    vector<bool> referenced(vertexCount, false);
+    size_t time = cacheSize + 1;
+    for (unsigned int index : indices)
+    {
+        if (time - loadedAt[index] > cacheSize)
+        {
+            loadedAt[index] = time++;
+            ++stats.TransformedVertices;
+        }
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++stats.UniqueVertices;
+        }
+    }
+    return stats;
+}
+
+/// <summary>
+/// Reorders triangles for post-transform cache reuse with Forsyth's greedy scoring.
+/// </summary>
+inline void OptimizeVertexCache(vector<unsigned int> &indices, size_t vertexCount)
+{
+    const float cacheDecayPower = 1.5f;
+    const float lastTriangleScore = 0.75f;
+    const float valenceBoostScale = 2.0f;
+    const float valenceBoostPower = 0.5f;
+
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // triangles using each vertex, stored back to back, live ones at the front of each range
+    vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices)
+    {
+        ++remaining[index];
+    }
+    vector<size_t> firstTriangle(vertexCount + 1, 0);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        firstTriangle[i + 1] = firstTriangle[i] + remaining[i];
+    }
+    vector<unsigned int> vertexTriangles(indices.size());
+    {
+        vector<size_t> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            vertexTriangles[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+    }
+
+    auto scoreVertex = [&](unsigned int liveTriangles, int cachePosition) -> float
+    {
+        if (liveTriangles == 0)
+        {
+            return -1.0f; // nothing left to draw with it
+        }
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                // used by the last triangle, a fixed score so strips aren't favoured too much
+                score = lastTriangleScore;
+            }
+            else
+            {
+                float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+                score = std::pow(1.0f - (cachePosition - 3) * scale, cacheDecayPower);
+            }
+        }
+        // vertices with few triangles left are finished off first
+        return score + valenceBoostScale * std::pow(static_cast<float>(liveTriangles),
+                                                    -valenceBoostPower);
+    };
+
+    vector<int> cachePositions(vertexCount, -1);
+    vector<float> vertexScores(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        vertexScores[i] = scoreVertex(remaining[i], -1);
+    }
+    vector<float> triangleScores(triangleCount);
+    for (size_t i = 0; i < triangleCount; ++i)
+    {
+        triangleScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] +
+                            vertexScores[indices[i * 3 + 2]];
+    }
+
+    vector<bool> emitted(triangleCount, false);
+    vector<unsigned int> result;
+    result.reserve(indices.size());
+    vector<unsigned int> cache;
+    vector<unsigned int> nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    size_t searchFrom = 0; // every triangle before this one was already emitted
+    int best = -1;
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        if (best < 0)
+        {
+            // nothing in the cache leads anywhere, continue with the next unused triangle
+            while (emitted[searchFrom])
+            {
+                ++searchFrom;
+            }
+            best = static_cast<int>(searchFrom);
+        }
+
+        unsigned int triangle = static_cast<unsigned int>(best);
+        emitted[triangle] = true;
+        nextCache.clear();
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int vertex = indices[triangle * 3 + corner];
+            result.push_back(vertex);
+            nextCache.push_back(vertex);
+
+            // move the triangle out of the vertex's live range
+            size_t begin = firstTriangle[vertex];
+            size_t end = begin + remaining[vertex];
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (vertexTriangles[i] == triangle)
+                {
+                    std::swap(vertexTriangles[i], vertexTriangles[end - 1]);
+                    --remaining[vertex];
+                    break;
+                }
+            }
+        }
+        for (unsigned int vertex : cache)
+        {
+            if (vertex != nextCache[0] && vertex != nextCache[1] && vertex != nextCache[2])
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        // rescore every vertex that was in either cache, the evicted ones drop out of it
+        for (size_t i = 0; i < nextCache.size(); ++i)
+        {
+            cachePositions[nextCache[i]] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+        }
+        for (unsigned int vertex : nextCache)
+        {
+            float score = scoreVertex(remaining[vertex], cachePositions[vertex]);
+            float delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+
+            size_t begin = firstTriangle[vertex];
+            for (size_t i = begin; i < begin + remaining[vertex]; ++i)
+            {
+                triangleScores[vertexTriangles[i]] += delta;
+            }
+        }
+
+        // the next triangle is the best one touching the cache
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int vertex : nextCache)
+        {
+            size_t begin = firstTriangle[vertex];
+            for (size_t i = begin; i < begin + remaining[vertex]; ++i)
+            {
+                unsigned int candidate = vertexTriangles[i];
+                if (triangleScores[candidate] > bestScore)
+                {
+                    bestScore = triangleScores[candidate];
+                    best = static_cast<int>(candidate);
+                }
+            }
+        }
+
+        if (nextCache.size() > FORSYTH_CACHE_SIZE)
+        {
+            nextCache.resize(FORSYTH_CACHE_SIZE);
+        }
+        std::swap(cache, nextCache);
+    }
+
+    indices.swap(result);
+}
+
+/// <summary>
+/// Sorts clusters of the cache optimized order so that outward facing ones are drawn first. Run
+/// it after OptimizeVertexCache, threshold bounds how much cache efficiency may be given up.
+/// </summary>
+inline void OptimizeOverdraw(vector<unsigned int> &indices,
+                             const vector<Vertex> &vertices,
+                             float threshold = OVERDRAW_THRESHOLD)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+    {
+        return;
+    }
+
+    // misses each triangle causes with a cache that is flushed at the given triangles
+    vector<size_t> loadedAt(vertices.size(), 0);
+    size_t time = 0;
+    auto flush = [&]() { time += VERTEX_CACHE_SIZE + 1; };
+    auto missesOf = [&](size_t triangle)
+    {
+        unsigned int misses = 0;
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int vertex = indices[triangle * 3 + corner];
+            if (time - loadedAt[vertex] > VERTEX_CACHE_SIZE)
+            {
+                loadedAt[vertex] = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    };
+
+    // hard boundaries: triangles that miss on every vertex start over anyway
+    vector<size_t> hardClusters;
+    flush();
+    for (size_t i = 0; i < triangleCount; ++i)
+    {
+        if (missesOf(i) == 3)
+        {
+            hardClusters.push_back(i);
+        }
+    }
+    hardClusters.push_back(triangleCount);
+
+    // soft boundaries: split a hard cluster wherever the part so far is nearly as cache friendly
+    // as the whole cluster, restarting the cache there costs at most the threshold
+    vector<size_t> clusters;
+    for (size_t cluster = 0; cluster + 1 < hardClusters.size(); ++cluster)
+    {
+        size_t start = hardClusters[cluster];
+        size_t end = hardClusters[cluster + 1];
+
+        flush();
+        size_t clusterMisses = 0;
+        for (size_t i = start; i < end; ++i)
+        {
+            clusterMisses += missesOf(i);
+        }
+        float limit = threshold * static_cast<float>(clusterMisses) / (end - start);
+
+        clusters.push_back(start);
+        flush();
+        size_t runningMisses = 0;
+        size_t runningTriangles = 0;
+        for (size_t i = start; i < end; ++i)
+        {
+            runningMisses += missesOf(i);
+            ++runningTriangles;
+            if (i + 1 < end && static_cast<float>(runningMisses) / runningTriangles <= limit)
+            {
+                clusters.push_back(i + 1);
+                flush();
+                runningMisses = runningTriangles = 0;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    // area weighted centroid and normal of every cluster and of the whole mesh
+    struct ClusterInfo
+    {
+        size_t Start;
+        size_t End;
+        glm::vec3 Centroid;
+        glm::vec3 Normal;
+        float Area;
+        float SortKey;
+    };
+    vector<ClusterInfo> infos(clusters.size() - 1);
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t cluster = 0; cluster < infos.size(); ++cluster)
+    {
+        ClusterInfo &info = infos[cluster];
+        info.Start = clusters[cluster];
+        info.End = clusters[cluster + 1];
+        info.Centroid = glm::vec3(0.0f);
+        info.Normal = glm::vec3(0.0f);
+        info.Area = 0.0f;
+        for (size_t i = info.Start; i < info.End; ++i)
+        {
+            const glm::vec3 &a = vertices[indices[i * 3]].Position;
+            const glm::vec3 &b = vertices[indices[i * 3 + 1]].Position;
+            const glm::vec3 &c = vertices[indices[i * 3 + 2]].Position;
+            glm::vec3 normal = glm::cross(b - a, c - a); // twice the area long
+            float area = glm::length(normal);
+            info.Centroid += (a + b + c) * (area / 3.0f);
+            info.Normal += normal;
+            info.Area += area;
+        }
+        meshCentroid += info.Centroid;
+        meshArea += info.Area;
+        info.Centroid = info.Area > 0.0f ? info.Centroid / info.Area : info.Centroid;
+    }
+    meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+    // clusters facing away from the middle of the mesh are the likely occluders
+    for (ClusterInfo &info : infos)
+    {
+        float normalLength = glm::length(info.Normal);
+        glm::vec3 normal = normalLength > 0.0f ? info.Normal / normalLength : info.Normal;
+        info.SortKey = glm::dot(info.Centroid - meshCentroid, normal);
+    }
+    std::stable_sort(infos.begin(), infos.end(), [](const ClusterInfo &a, const ClusterInfo &b) {
+        return a.SortKey > b.SortKey;
+    });
+
+    vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const ClusterInfo &info : infos)
+    {
+        result.insert(
+            result.end(), indices.begin() + info.Start * 3, indices.begin() + info.End * 3);
+    }
+    indices.swap(result);
+}
+
+/// <summary>
+/// Renumbers vertices in the order the indices first use them and drops unreferenced ones. The
+/// vertices are permuted in place, so their buffer is not reallocated.
+/// </summary>
+inline void OptimizeVertexFetch(vector<Vertex> &vertices, vector<unsigned int> &indices)
+{
+    const unsigned int unused = ~0u;
+    vector<unsigned int> remap(vertices.size(), unused);
+    unsigned int next = 0;
+    for (unsigned int &index : indices)
+    {
+        if (remap[index] == unused)
+        {
+            remap[index] = next++;
+        }
+        index = remap[index];
+    }
+    unsigned int referenced = next;
+    for (unsigned int &target : remap)
+    {
+        if (target == unused)
+        {
+            target = next++; // moved behind the used ones, then cut off
+        }
+    }
+
+    // follow the permutation's cycles, every swap puts one vertex in its final place
+    for (unsigned int i = 0; i < remap.size(); ++i)
+    {
+        while (remap[i] != i)
+        {
+            unsigned int target = remap[i];
+            std::swap(vertices[i], vertices[target]);
+            std::swap(remap[i], remap[target]);
+        }
+    }
+    vertices.resize(referenced);
+}
+
+/// <summary>
+/// Cache statistics of a set of meshes before and after optimizing them.
+/// </summary>
+struct MeshOptimizationReport
+{
+    VertexCacheStats Before;
+    VertexCacheStats After;
+    unsigned int MeshCount = 0;
+
+    void Print(const std::string &label) const
+    {
+        std::cout << "MESH_OPTIMIZER:: " << label << " (" << MeshCount << " meshes): ACMR "
+                  << Before.GetACMR() << " -> " << After.GetACMR() << " | ATVR "
+                  << Before.GetATVR() << " -> " << After.GetATVR() << std::endl;
+    }
+};
+
+/// <summary>
+/// Runs all three passes on a mesh, adding its statistics to the report.
+/// </summary>
+inline void OptimizeMesh(vector<Vertex> &vertices,
+                         vector<unsigned int> &indices,
+                         MeshOptimizationReport &report)
+{
+    report.Before.Add(AnalyzeVertexCache(indices, vertices.size()));
+    OptimizeVertexCache(indices, vertices.size());
+    OptimizeOverdraw(indices, vertices);
+    OptimizeVertexFetch(vertices, indices);
+    report.After.Add(AnalyzeVertexCache(indices, vertices.size()));
+    ++report.MeshCount;
+}
+
+#endif
@@ -0,0 +1,296 @@
+#ifndef MESH_SIMPLIFIER_H
+#define MESH_SIMPLIFIER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include <vertex_format.h>
+
+using std::vector;
+
+// Edge collapse simplification driven by quadric error metrics (Garland and Heckbert). Only
+// collapses of a vertex onto one of its neighbours are done, so every simplified index buffer
+// still points into the original vertices and all levels of detail share one vertex buffer.
+//
+// Vertices on an open border are never moved. In the index topology an attribute seam (a UV or
+// normal split, where one position has several vertices) looks exactly like a border, so seams
+// stay intact as well and textures don't tear.
+
+// a collapse is rejected when it turns a neighbouring triangle by more than about 75 degrees
+const float SIMPLIFY_MAX_NORMAL_TURN = 0.25f;
+
+/// <summary>
+/// Sum of squared distances to a set of planes, as a symmetric 4x4 matrix. Each plane counts with
+/// the area of the triangle it came from.
+/// </summary>
+struct Quadric
+{
+    double XX = 0.0, YY = 0.0, ZZ = 0.0, XY = 0.0, XZ = 0.0, YZ = 0.0;
+    double XW = 0.0, YW = 0.0, ZW = 0.0, WW = 0.0;
+    double Weight = 0.0;
+
+    /// <summary>
+    /// Adds the plane a*x + b*y + c*z + d = 0, (a, b, c) has to be unit length.
+    /// </summary>
+    void AddPlane(double a, double b, double c, double d, double weight)
+    {
+        XX += a * a * weight;
+        YY += b * b * weight;
+        ZZ += c * c * weight;
+        XY += a * b * weight;
+        XZ += a * c * weight;
+        YZ += b * c * weight;
+        XW += a * d * weight;
+        YW += b * d * weight;
+        ZW += c * d * weight;
+        WW += d * d * weight;
+        Weight += weight;
+    }
+
+    void Add(const Quadric &other)
+    {
+        XX += other.XX;
+        YY += other.YY;
+        ZZ += other.ZZ;
+        XY += other.XY;
+        XZ += other.XZ;
+        YZ += other.YZ;
+        XW += other.XW;
+        YW += other.YW;
+        ZW += other.ZW;
+        WW += other.WW;
+        Weight += other.Weight;
+    }
+
+    /// <summary>
+    /// Returns the weighted average distance of a point to the planes.
+    /// </summary>
+    double GetError(const glm::vec3 &point) const
+    {
+        double x = point.x, y = point.y, z = point.z;
+        double sum = x * x * XX + y * y * YY + z * z * ZZ +
+                     2.0 * (x * y * XY + x * z * XZ + y * z * YZ + x * XW + y * YW + z * ZW) + WW;
+        return Weight > 0.0 ? std::sqrt(std::max(sum, 0.0) / Weight) : 0.0;
+    }
+};
+
+/// <summary>
+/// Simplifies a triangle list down to about targetIndexCount indices, without letting any collapse
+/// move the surface by more than maxError (in the units of the positions). Stops early when no
+/// collapse is allowed anymore. resultError, if given, receives the largest error of a collapse
+/// that was done.
+/// </summary>
+inline vector<unsigned int> SimplifyMesh(const vector<Vertex> &vertices,
+                                         const vector<unsigned int> &indices,
+                                         size_t targetIndexCount,
+                                         float maxError,
+                                         float *resultError = nullptr)
+{
+    size_t vertexCount = vertices.size();
+    vector<unsigned int> result = indices;
+    float largestError = 0.0f;
+
+    // every directed edge of the triangles, an edge without its reverse is on a border or seam
+    auto edgeKey = [](unsigned int from, unsigned int to)
+    { return (static_cast<uint64_t>(from) << 32) | to; };
+    std::unordered_set<uint64_t> edges;
+    edges.reserve(indices.size());
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            edges.insert(edgeKey(indices[i + corner], indices[i + (corner + 1) % 3]));
+        }
+    }
+    vector<uint8_t> locked(vertexCount, 0);
+    for (uint64_t edge : edges)
+    {
+        unsigned int from = static_cast<unsigned int>(edge >> 32);
+        unsigned int to = static_cast<unsigned int>(edge & 0xffffffffu);
+        if (edges.count(edgeKey(to, from)) == 0)
+        {
+            locked[from] = 1;
+            locked[to] = 1;
+        }
+    }
+
+    // the planes of the triangles around each vertex
+    vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        const glm::vec3 &a = vertices[indices[i]].Position;
+        const glm::vec3 &b = vertices[indices[i + 1]].Position;
+        const glm::vec3 &c = vertices[indices[i + 2]].Position;
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        if (length <= 0.0f)
+        {
+            continue;
+        }
+        normal /= length;
+        double area = length * 0.5;
+        double d = -glm::dot(normal, a);
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            quadrics[indices[i + corner]].AddPlane(normal.x, normal.y, normal.z, d, area);
+        }
+    }
+
+    struct Collapse
+    {
+        unsigned int From;
+        unsigned int To;
+        float Error;
+    };
+    vector<Collapse> collapses;
+    vector<unsigned int> remap(vertexCount);
+    vector<uint8_t> touched(vertexCount);
+    vector<unsigned int> triangleOffsets(vertexCount + 1);
+    vector<unsigned int> vertexTriangles;
+
+    // Collapses are done in passes. Each pass ranks every possible collapse and then does the
+    // cheapest ones that don't touch each other, so the ranking stays valid through the pass.
+    while (result.size() > targetIndexCount)
+    {
+        // triangles around each vertex, for the flip test
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+        for (unsigned int index : result)
+        {
+            ++triangleOffsets[index + 1];
+        }
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            triangleOffsets[v + 1] += triangleOffsets[v];
+        }
+        vertexTriangles.resize(result.size());
+        vector<unsigned int> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            vertexTriangles[cursors[result[i]]++] = static_cast<unsigned int>(i / 3);
+        }
+
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                unsigned int from = result[i + corner];
+                unsigned int to = result[i + (corner + 1) % 3];
+                if (locked[from])
+                {
+                    continue;
+                }
+                Quadric merged = quadrics[from];
+                merged.Add(quadrics[to]);
+                float error = static_cast<float>(merged.GetError(vertices[to].Position));
+                if (error <= maxError)
+                {
+                    collapses.push_back(Collapse{from, to, error});
+                }
+            }
+        }
+        std::sort(collapses.begin(),
+                  collapses.end(),
+                  [](const Collapse &a, const Collapse &b) { return a.Error < b.Error; });
+
+        // each collapse removes about two triangles
+        size_t trianglesToRemove = (result.size() - targetIndexCount) / 3;
+        size_t maxCollapses = std::max<size_t>(trianglesToRemove / 2, 1);
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            remap[v] = static_cast<unsigned int>(v);
+        }
+        std::fill(touched.begin(), touched.end(), 0);
+
+        size_t collapsed = 0;
+        for (const Collapse &collapse : collapses)
+        {
+            if (collapsed >= maxCollapses)
+            {
+                break;
+            }
+            if (touched[collapse.From] || touched[collapse.To])
+            {
+                continue;
+            }
+
+            // moving From onto To must not fold any of the triangles that stay over
+            bool flips = false;
+            const glm::vec3 &target = vertices[collapse.To].Position;
+            for (unsigned int t = triangleOffsets[collapse.From];
+                 !flips && t < triangleOffsets[collapse.From + 1];
+                 ++t)
+            {
+                const unsigned int *triangle = &result[vertexTriangles[t] * 3];
+                if (triangle[0] == collapse.To || triangle[1] == collapse.To ||
+                    triangle[2] == collapse.To)
+                {
+                    continue; // collapses away
+                }
+                glm::vec3 before[3], after[3];
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    before[corner] = vertices[triangle[corner]].Position;
+                    after[corner] = triangle[corner] == collapse.From ? target : before[corner];
+                }
+                glm::vec3 normalBefore =
+                    glm::cross(before[1] - before[0], before[2] - before[0]);
+                glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+                float limit = SIMPLIFY_MAX_NORMAL_TURN * glm::length(normalBefore) *
+                              glm::length(normalAfter);
+                flips = glm::dot(normalBefore, normalAfter) <= limit;
+            }
+            if (flips)
+            {
+                continue;
+            }
+
+            // the triangles around From change, nothing else may collapse into them this pass
+            for (unsigned int t = triangleOffsets[collapse.From];
+                 t < triangleOffsets[collapse.From + 1];
+                 ++t)
+            {
+                const unsigned int *triangle = &result[vertexTriangles[t] * 3];
+                touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = 1;
+            }
+            remap[collapse.From] = collapse.To;
+            quadrics[collapse.To].Add(quadrics[collapse.From]);
+            largestError = std::max(largestError, collapse.Error);
+            ++collapsed;
+        }
+        if (collapsed == 0)
+        {
+            break;
+        }
+
+        // apply the collapses, triangles that lost a corner disappear
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3)
+        {
+            unsigned int a = remap[result[i]];
+            unsigned int b = remap[result[i + 1]];
+            unsigned int c = remap[result[i + 2]];
+            if (a != b && b != c && a != c)
+            {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        result.resize(write);
+    }
+
+    if (resultError != nullptr)
+    {
+        *resultError = largestError;
+    }
+    return result;
+}
+
+#endif
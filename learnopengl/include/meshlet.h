@@ -0,0 +1,220 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <vertex_format.h>
+
+using std::vector;
+
+// Size limits of a meshlet, the ones mesh shading hardware is built around. Small clusters cull
+// tightly, but each visible one still costs a draw range.
+const unsigned int MESHLET_MAX_VERTICES = 64;
+const unsigned int MESHLET_MAX_TRIANGLES = 124;
+
+/// <summary>
+/// A small cluster of neighbouring triangles of a mesh with the bounds needed to cull it on its
+/// own: a bounding sphere for the frustum and a cone around the normals of its triangles for back
+/// facing clusters.
+/// </summary>
+struct Meshlet
+{
+    unsigned int FirstIndex; // relative to the mesh's own first index
+    unsigned int IndexCount;
+    glm::vec3 Center; // object space bounding sphere
+    float Radius;
+    glm::vec3 ConeAxis; // average normal of the triangles
+    float ConeCutoff;   // sine of the cone's half angle, 1 if the cluster can always be seen
+};
+
+/// <summary>
+/// Returns true if every triangle of the meshlet faces away from a camera at cameraPosition, both
+/// in object space. Conservative: the whole bounding sphere has to be behind the cone.
+/// </summary>
+inline bool IsMeshletBackFacing(const Meshlet &meshlet, const glm::vec3 &cameraPosition)
+{
+    glm::vec3 toCenter = meshlet.Center - cameraPosition;
+    return glm::dot(toCenter, meshlet.ConeAxis) >=
+           meshlet.ConeCutoff * glm::length(toCenter) + meshlet.Radius;
+}
+
+/// <summary>
+/// Splits the first indexCount indices (the full detail level) into meshlets and reorders those
+/// indices so every meshlet is one contiguous range. A meshlet is grown from the first triangle not
+/// taken yet by adding the neighbouring triangle that brings in the fewest new vertices, the
+/// closest one on a tie, until a limit is reached or no neighbour is left.
+/// </summary>
+inline vector<Meshlet> BuildMeshlets(const vector<Vertex> &vertices,
+                                     vector<unsigned int> &indices,
+                                     size_t indexCount)
+{
+    size_t vertexCount = vertices.size();
+    size_t triangleCount = indexCount / 3;
+    vector<Meshlet> meshlets;
+
+    // triangles around each vertex
+    vector<unsigned int> triangleOffsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        ++triangleOffsets[indices[i] + 1];
+    }
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        triangleOffsets[v + 1] += triangleOffsets[v];
+    }
+    vector<unsigned int> vertexTriangles(triangleCount * 3);
+    vector<unsigned int> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        vertexTriangles[cursors[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    vector<glm::vec3> centroids(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        centroids[t] = (vertices[indices[t * 3]].Position + vertices[indices[t * 3 + 1]].Position +
+                        vertices[indices[t * 3 + 2]].Position) /
+                       3.0f;
+    }
+
+    vector<unsigned int> ordered;
+    ordered.reserve(triangleCount * 3);
+    vector<uint8_t> taken(triangleCount, 0);
+    vector<uint8_t> inMeshlet(vertexCount, 0);
+    vector<unsigned int> meshletVertices;
+    vector<unsigned int> meshletTriangles;
+    size_t nextSeed = 0;
+
+    auto newVertexCount = [&](size_t triangle) {
+        return static_cast<unsigned int>(!inMeshlet[indices[triangle * 3]]) +
+               !inMeshlet[indices[triangle * 3 + 1]] + !inMeshlet[indices[triangle * 3 + 2]];
+    };
+    auto addTriangle = [&](size_t triangle) {
+        taken[triangle] = 1;
+        meshletTriangles.push_back(static_cast<unsigned int>(triangle));
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            unsigned int vertex = indices[triangle * 3 + corner];
+            if (!inMeshlet[vertex])
+            {
+                inMeshlet[vertex] = 1;
+                meshletVertices.push_back(vertex);
+            }
+        }
+    };
+
+    while (true)
+    {
+        while (nextSeed < triangleCount && taken[nextSeed])
+        {
+            ++nextSeed;
+        }
+        if (nextSeed == triangleCount)
+        {
+            break;
+        }
+
+        addTriangle(nextSeed);
+        glm::vec3 centroidSum = centroids[nextSeed];
+        while (meshletTriangles.size() < MESHLET_MAX_TRIANGLES)
+        {
+            glm::vec3 centroid = centroidSum / static_cast<float>(meshletTriangles.size());
+            size_t best = triangleCount;
+            unsigned int bestNew = 3;
+            float bestDistance = 0.0f;
+            for (unsigned int vertex : meshletVertices)
+            {
+                for (unsigned int i = triangleOffsets[vertex]; i < triangleOffsets[vertex + 1]; ++i)
+                {
+                    unsigned int triangle = vertexTriangles[i];
+                    if (taken[triangle])
+                    {
+                        continue;
+                    }
+                    unsigned int added = newVertexCount(triangle);
+                    if (meshletVertices.size() + added > MESHLET_MAX_VERTICES || added > bestNew)
+                    {
+                        continue;
+                    }
+                    glm::vec3 offset = centroids[triangle] - centroid;
+                    float distance = glm::dot(offset, offset);
+                    if (added < bestNew || distance < bestDistance)
+                    {
+                        best = triangle;
+                        bestNew = added;
+                        bestDistance = distance;
+                    }
+                }
+            }
+            if (best == triangleCount)
+            {
+                break; // full, or the rest of the surface isn't connected to this meshlet
+            }
+            addTriangle(best);
+            centroidSum += centroids[best];
+        }
+
+        Meshlet meshlet;
+        meshlet.FirstIndex = static_cast<unsigned int>(ordered.size());
+        meshlet.IndexCount = static_cast<unsigned int>(meshletTriangles.size() * 3);
+
+        // sphere around the box of the vertices, like the mesh's own
+        glm::vec3 boundsMin = vertices[meshletVertices[0]].Position;
+        glm::vec3 boundsMax = boundsMin;
+        for (unsigned int vertex : meshletVertices)
+        {
+            boundsMin = glm::min(boundsMin, vertices[vertex].Position);
+            boundsMax = glm::max(boundsMax, vertices[vertex].Position);
+        }
+        meshlet.Center = (boundsMin + boundsMax) * 0.5f;
+        float radiusSquared = 0.0f;
+        for (unsigned int vertex : meshletVertices)
+        {
+            glm::vec3 offset = vertices[vertex].Position - meshlet.Center;
+            radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+            inMeshlet[vertex] = 0;
+        }
+        meshlet.Radius = std::sqrt(radiusSquared);
+
+        // the cone around the face normals, weighted by area so slivers don't tilt it
+        vector<glm::vec3> normals;
+        glm::vec3 axis(0.0f);
+        for (unsigned int triangle : meshletTriangles)
+        {
+            const glm::vec3 &a = vertices[indices[triangle * 3]].Position;
+            const glm::vec3 &b = vertices[indices[triangle * 3 + 1]].Position;
+            const glm::vec3 &c = vertices[indices[triangle * 3 + 2]].Position;
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float length = glm::length(normal);
+            if (length > 0.0f)
+            {
+                axis += normal;
+                normals.push_back(normal / length);
+            }
+            ordered.insert(ordered.end(), &indices[triangle * 3], &indices[triangle * 3] + 3);
+        }
+        float axisLength = glm::length(axis);
+        meshlet.ConeAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+        float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+        for (const glm::vec3 &normal : normals)
+        {
+            minDot = std::min(minDot, glm::dot(normal, meshlet.ConeAxis));
+        }
+        // normals spread over a half sphere or more can always face the camera
+        meshlet.ConeCutoff = minDot > 0.0f ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+
+        meshlets.push_back(meshlet);
+        meshletVertices.clear();
+        meshletTriangles.clear();
+    }
+
+    std::copy(ordered.begin(), ordered.end(), indices.begin());
+    return meshlets;
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef MESHLET_CULLER_H
+#define MESHLET_CULLER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <frame_stats.h>
+#include <frustum.h>
+#include <mesh.h>
+#include <meshlet.h>
+
+using std::vector;
+
+/// <summary>
+/// Culls the meshlets of one mesh draw at a time against the frustum and the camera direction and
+/// draws the survivors with a single glMultiDrawElementsBaseVertex. Visible meshlets that follow
+/// each other in the index buffer are merged into one range, so an unculled mesh is still one
+/// range.
+/// </summary>
+struct MeshletCuller
+{
+public:
+    /// <summary>
+    /// Sets the camera for the following culls, frustum and position in world space.
+    /// </summary>
+    void SetCamera(const Frustum &frustum, const glm::vec3 &cameraPosition)
+    {
+        ViewFrustum = frustum;
+        CameraPosition = cameraPosition;
+    }
+
+    /// <summary>
+    /// Collects the index ranges of the mesh's visible meshlets when drawn with transform and
+    /// returns how many ranges there are. The cone test assumes transform doesn't shear or scale
+    /// unevenly, which would bend the normals.
+    /// </summary>
+    size_t Cull(const Mesh &mesh, const glm::mat4 &transform)
+    {
+        Counts.clear();
+        Offsets.clear();
+        BaseVertices.clear();
+
+        // bring the camera into object space instead of every meshlet into world space. A world
+        // plane p becomes transpose(transform) * p there and still measures world distances
+        glm::vec3 camera = glm::vec3(glm::inverse(transform) * glm::vec4(CameraPosition, 1.0f));
+        glm::mat4 transposed = glm::transpose(transform);
+        glm::vec4 planes[6];
+        for (int i = 0; i < 6; ++i)
+        {
+            planes[i] = transposed * ViewFrustum.Planes[i];
+        }
+        float scale = std::max(glm::length(glm::vec3(transform[0])),
+                               std::max(glm::length(glm::vec3(transform[1])),
+                                        glm::length(glm::vec3(transform[2]))));
+
+        size_t indexSize = mesh.GetIndexSize();
+        unsigned int rangeEnd = ~0u; // end of the last range, to extend it
+        for (const Meshlet &meshlet : mesh.Meshlets)
+        {
+            bool visible = !IsMeshletBackFacing(meshlet, camera);
+            glm::vec4 center(meshlet.Center, 1.0f);
+            for (int i = 0; visible && i < 6; ++i)
+            {
+                visible = glm::dot(planes[i], center) + meshlet.Radius * scale >= 0.0f;
+            }
+            if (!visible)
+            {
+                ++frameStats.MeshletsCulled;
+                continue;
+            }
+            ++frameStats.MeshletsVisible;
+
+            if (meshlet.FirstIndex == rangeEnd)
+            {
+                Counts.back() += static_cast<GLsizei>(meshlet.IndexCount);
+            }
+            else
+            {
+                size_t offset = (mesh.FirstIndex + meshlet.FirstIndex) * indexSize;
+                Counts.push_back(static_cast<GLsizei>(meshlet.IndexCount));
+                Offsets.push_back(reinterpret_cast<const void *>(offset));
+                BaseVertices.push_back(mesh.BaseVertex);
+            }
+            rangeEnd = meshlet.FirstIndex + meshlet.IndexCount;
+        }
+        return Counts.size();
+    }
+
+    /// <summary>
+    /// Draws the ranges of the last Cull. The vertex array holding the mesh has to be bound.
+    /// </summary>
+    void Draw(const Mesh &mesh) const
+    {
+        if (Counts.empty())
+        {
+            return;
+        }
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES,
+                                      Counts.data(),
+                                      mesh.IndexType,
+                                      Offsets.data(),
+                                      static_cast<GLsizei>(Counts.size()),
+                                      BaseVertices.data());
+        ++frameStats.DrawCalls;
+        for (GLsizei count : Counts)
+        {
+            frameStats.TrianglesDrawn += count / 3;
+        }
+    }
+
+private:
+    Frustum ViewFrustum = {};
+    glm::vec3 CameraPosition = glm::vec3(0.0f);
+    vector<GLsizei> Counts;
+    vector<const void *> Offsets;
+    vector<GLint> BaseVertices;
+};
+
+#endif
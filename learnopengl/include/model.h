@@ -6,18 +6,33 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <stb_image.h>
 #include <assimp/Importer.hpp>
+#include <assimp/DefaultIOSystem.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
+#include <filesystem>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <unordered_set>
 #include <vector>
 
+#include <animation.h>
 #include <shader.h>
+#include <material.h>
 #include <mesh.h>
+#include <mesh_cache.h>
+#include <mesh_optimizer.h>
+#include <mesh_simplifier.h>
+#include <job_system.h>
+#include <lod_selector.h>
+#include <model_geometry.h>
+#include <render_queue.h>
+#include <scene_graph.h>
+#include <texture_cache.h>
 
 using std::cout;
 using std::endl;
@@ -27,38 +42,380 @@ using std::map;
 using std::string;
 using std::vector;
 
+/// <summary>
+/// Assimp's default file system that records the path of every file an import opens, e.g. the
+/// material library of an .obj, so the mesh cache can tell when one of them changed.
+/// </summary>
+struct RecordingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    explicit RecordingIOSystem(vector<string> &files) : Files(files)
+    {
+    }
+
+    Assimp::IOStream *Open(const char *file, const char *mode = "rb") override
+    {
+        Assimp::IOStream *stream = DefaultIOSystem::Open(file, mode);
+        if (stream != nullptr && std::find(Files.begin(), Files.end(), file) == Files.end())
+        {
+            Files.push_back(file);
+        }
+        return stream;
+    }
+
+private:
+    vector<string> &Files;
+};
+
+/// <summary>
+/// Pixels of an image file decoded by stb_image, not yet uploaded to the GPU.
+/// </summary>
+struct DecodedImage
+{
+    unsigned char *Data = nullptr;
+    int Width = 0;
+    int Height = 0;
+    int NumChannels = 0;
+};
+
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma);
+DecodedImage DecodeImage(const char *path, const string &directory);
+unsigned int UploadTexture(DecodedImage &image, const char *path, bool gamma);
+glm::mat4 ToGlmMatrix(const aiMatrix4x4 &matrix);
+
+// post processing steps applied to every imported model, also part of the mesh cache key
+const unsigned int MODEL_IMPORT_FLAGS =
+    aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs |
+    aiProcess_CalcTangentSpace;
+
+// levels of detail generated per mesh at most, the full mesh included
+const unsigned int MESH_LOD_COUNT = 4;
+// how far a level may move the surface, relative to the radius of the mesh's bounding sphere
+const float MESH_LOD_MAX_ERROR = 0.05f;
+// a level that keeps more of the previous level's indices than this isn't worth its memory
+const float MESH_LOD_MIN_REDUCTION = 0.8f;
+
+struct ModelTextureType
+{
+    aiTextureType Type;
+    const char *Name; // sampler name prefix in the shaders
+};
+
+// we assume a convention for sampler names in the shaders. Each diffuse texture should be named as
+// 'texture_diffuseN' where N is a sequential number ranging from 1 to MAX_SAMPLER_NUMBER. Same
+// applies to the other textures as the following list summarizes:
+const ModelTextureType MODEL_TEXTURE_TYPES[] = {
+    {aiTextureType_DIFFUSE, "texture_diffuse"},   // 1. diffuse maps
+    {aiTextureType_SPECULAR, "texture_specular"}, // 2. specular maps
+    {aiTextureType_HEIGHT, "texture_normal"},     // 3. normal maps
+    {aiTextureType_AMBIENT, "texture_height"},    // 4. height maps
+};
+
+struct ModelLoadOptions
+{
+    // load from / write to a binary cache next to the source file instead of importing with
+    // assimp every time
+    bool UseMeshCache = true;
+    // decode the image files of all textures on the job system's workers, only the uploads happen
+    // on the thread that owns the GL context
+    bool ParallelTextureDecode = true;
+    // GPU vertex layout of the meshes, Compact quantizes them to a fraction of the size
+    VertexFormat Format = VertexFormat::Full;
+    // keep the vertices and indices in system memory after they are uploaded, only needed by CPU
+    // side consumers like picking or collision
+    bool KeepCpuGeometry = false;
+    // reorder each imported mesh for the vertex cache, overdraw and vertex fetch, the result is
+    // stored in the mesh cache so warm starts don't pay for it again
+    bool OptimizeMeshes = false;
+    // simplify each imported mesh into a chain of levels of detail that share its vertices, see
+    // LodSelector. Also stored in the mesh cache
+    bool GenerateLods = false;
+    // split the full detail level of each imported mesh into meshlets for cluster culling, see
+    // RenderQueue::SetMeshletCulling. Also stored in the mesh cache
+    bool GenerateMeshlets = false;
+};
+
+/// <summary>
+/// Where the geometry of a model lives, in bytes.
+/// </summary>
+struct ModelMemoryUsage
+{
+    size_t GpuVertexBytes = 0;
+    size_t GpuIndexBytes = 0;
+    size_t CpuGeometryBytes = 0;      // vertices and indices still held in system memory
+    size_t ReleasedGeometryBytes = 0; // CPU copies freed after uploading
+
+    void Print(const string &label) const
+    {
+        const double kilobyte = 1024.0;
+        double gpuBytes = static_cast<double>(GpuVertexBytes + GpuIndexBytes);
+        cout << "MODEL::MEMORY:: " << label << ": GPU " << gpuBytes / kilobyte << " KB (vertices "
+             << GpuVertexBytes / kilobyte << " KB, indices " << GpuIndexBytes / kilobyte
+             << " KB) | CPU " << CpuGeometryBytes / kilobyte << " KB | released after upload "
+             << ReleasedGeometryBytes / kilobyte << " KB" << endl;
+    }
+};
+
+/// <summary>
+/// A node of the imported hierarchy. Nodes are stored parents first, so Parent is always smaller
+/// than the node's own index (-1 for the root).
+/// </summary>
+struct ModelNode
+{
+    string Name;
+    int Parent;
+    glm::mat4 Transform; // relative to the parent
+    vector<unsigned int> MeshIndices; // into Model::Meshes
+};
 
 struct Model
 {
 public:
-    Model(string const &path, bool gamma = false) : ShouldGammaCorrect(gamma)
+    Model(string const &path, bool gamma = false, ModelLoadOptions options = ModelLoadOptions())
+        : ShouldGammaCorrect(gamma), Options(options)
     {
         LoadModel(path);
     }
 
+    ~Model()
+    {
+        // give back the references to the shared textures, the last model using one deletes it
+        for (const Texture &texture : LoadedTextures)
+        {
+            TextureCache::Get().Release(texture.ID);
+        }
+    }
+
+    // a model holds references to shared textures, copies would release them twice
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
+
+    /// <summary>
+    /// Draws the model untransformed. Sets the shader's model matrix to each node's world
+    /// transform, a "model" set before the call is overwritten; pass it to the overload below.
+    /// </summary>
     void Draw(Shader &shader)
     {
-        for (unsigned int i = 0; i < Meshes.size(); ++i)
+        Draw(shader, glm::mat4(1.0f));
+    }
+
+    /// <summary>
+    /// Draws every node's meshes, setting the shader's model matrix to transform times the node's
+    /// world transform. Skinned meshes only get transform, their bone matrices already place them
+    /// in the model (see Animator). With lods, each mesh is drawn at the level it picks.
+    /// </summary>
+    void Draw(Shader &shader, const glm::mat4 &transform, const LodSelector *lods = nullptr)
+    {
+        Graph.Update();
+        int modelLocation = shader.GetUniformLocation("model");
+
+        // one vertex array for the whole model, the meshes only pick their ranges
+        Geometry.Bind();
+        for (size_t node = 0; node < Nodes.size(); ++node)
+        {
+            if (Nodes[node].MeshIndices.empty())
+            {
+                continue;
+            }
+            glm::mat4 nodeModel = transform * Graph.WorldTransforms[node];
+            int uploaded = -1; // whether the uniform holds the skinned or the node matrix
+            for (unsigned int mesh : Nodes[node].MeshIndices)
+            {
+                int skinned = Meshes[mesh].HasBones ? 1 : 0;
+                if (skinned != uploaded)
+                {
+                    const glm::mat4 &model = skinned ? transform : nodeModel;
+                    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &model[0][0]);
+                    uploaded = skinned;
+                }
+                // skinned meshes are selected by their bind pose
+                unsigned int lod =
+                    lods != nullptr ? lods->Select(Meshes[mesh], skinned ? transform : nodeModel)
+                                    : 0;
+                Meshes[mesh].Draw(shader, lod);
+            }
+        }
+        glBindVertexArray(0);
+    }
+
+    /// <summary>
+    /// Draws the model posed by an animator with a skinning shader, see shaders/3.11.1.skinning.vs.
+    /// The bone matrices go through boneBuffer, which is bound to the shader's BoneMatrices block.
+    /// </summary>
+    void DrawSkinned(Shader &shader,
+                     const glm::mat4 &transform,
+                     const Animator &animator,
+                     BoneMatrixBuffer &boneBuffer)
+    {
+        boneBuffer.Upload(animator.GetBoneMatrices());
+        Draw(shader, transform);
+    }
+
+    /// <summary>
+    /// Draws the model once for every transform with a single draw call per mesh. The shader takes
+    /// the instance's matrix from the attribute at INSTANCE_TRANSFORM_LOCATION and the node's world
+    /// transform from the model uniform, see shaders/3.10.1.instancing.vs.
+    /// </summary>
+    void DrawInstanced(Shader &shader, const vector<glm::mat4> &transforms)
+    {
+        if (transforms.empty())
+        {
+            return;
+        }
+        Graph.Update();
+        int modelLocation = shader.GetUniformLocation("model");
+
+        Geometry.SetInstanceTransforms(transforms.data(), transforms.size());
+        Geometry.Bind();
+        for (size_t node = 0; node < Nodes.size(); ++node)
+        {
+            if (Nodes[node].MeshIndices.empty())
+            {
+                continue;
+            }
+            glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &Graph.WorldTransforms[node][0][0]);
+            for (unsigned int mesh : Nodes[node].MeshIndices)
+            {
+                MaterialRegistry::Get().Bind(Meshes[mesh].MaterialID, shader);
+                Meshes[mesh].DrawInstancedRange(static_cast<unsigned int>(transforms.size()));
+            }
+        }
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    /// <summary>
+    /// Queues every node's meshes for drawing with the given shader, placed by transform times the
+    /// node's world transform (only transform for skinned meshes, like Draw).
+    /// </summary>
+    void Submit(RenderQueue &queue,
+                Shader &shader,
+                const glm::mat4 &transform,
+                RenderPass pass = RenderPass::Opaque)
+    {
+        Graph.Update();
+        int skinnedIndex = -1; // added on the first skinned mesh
+        for (size_t node = 0; node < Nodes.size(); ++node)
         {
-            Meshes[i].Draw(shader);
+            if (Nodes[node].MeshIndices.empty())
+            {
+                continue;
+            }
+            unsigned int transformIndex =
+                queue.AddTransform(transform * Graph.WorldTransforms[node]);
+            for (unsigned int mesh : Nodes[node].MeshIndices)
+            {
+                unsigned int meshTransform = transformIndex;
+                if (Meshes[mesh].HasBones)
+                {
+                    if (skinnedIndex < 0)
+                    {
+                        skinnedIndex = static_cast<int>(queue.AddTransform(transform));
+                    }
+                    meshTransform = static_cast<unsigned int>(skinnedIndex);
+                }
+                queue.Submit(pass, shader, Meshes[mesh], Geometry.GetVertexArray(), meshTransform);
+            }
         }
     }
 
-    vector<Texture> LoadedTextures;
+    vector<Texture> LoadedTextures; // every texture this model holds a reference to
     vector<Mesh> Meshes;
+    ModelGeometry Geometry; // vertex and index buffers shared by all meshes
+    MeshOptimizationReport OptimizationReport; // filled when meshes are optimized on import
+    vector<ModelNode> Nodes; // the hierarchy as imported, with the meshes of each node
+    SceneGraph Graph;        // the node transforms at runtime, in the same order as Nodes
+    std::map<string, BoneInfo> BoneInfoMap; // bone name -> ID and offset, shared by all meshes
+    int BoneCount = 0;
     string Directory;
     bool ShouldGammaCorrect;
+    ModelLoadOptions Options;
+
+    /// <summary>
+    /// Sums up the geometry memory of all meshes.
+    /// </summary>
+    ModelMemoryUsage GetMemoryUsage() const
+    {
+        ModelMemoryUsage usage;
+        for (const Mesh &mesh : Meshes)
+        {
+            usage.GpuVertexBytes += mesh.GetVertexBufferSize();
+            usage.GpuIndexBytes += mesh.GetIndexBufferSize();
+            usage.CpuGeometryBytes += mesh.GetCpuGeometrySize();
+        }
+        usage.ReleasedGeometryBytes = ReleasedGeometryBytes;
+        return usage;
+    }
+
+    /// <summary>
+    /// Returns the skeleton animators pose this model with. Bones are matched to the nodes of the
+    /// same name.
+    /// </summary>
+    Skeleton GetSkeleton() const
+    {
+        Skeleton skeleton;
+        for (const ModelNode &node : Nodes)
+        {
+            skeleton.NodeNames.push_back(node.Name);
+            skeleton.Parents.push_back(node.Parent);
+            skeleton.RestTransforms.push_back(node.Transform);
+        }
+        skeleton.BoneNodes.assign(BoneCount, -1);
+        skeleton.BoneOffsets.assign(BoneCount, glm::mat4(1.0f));
+        for (const auto &bone : BoneInfoMap)
+        {
+            skeleton.BoneNodes[bone.second.ID] = skeleton.FindNode(bone.first);
+            skeleton.BoneOffsets[bone.second.ID] = bone.second.Offset;
+        }
+        return skeleton;
+    }
 
 private:
+    // path as written in the material -> index into LoadedTextures
+    std::unordered_map<string, size_t> LoadedTextureIndices;
+    size_t ReleasedGeometryBytes = 0;
+
     void LoadModel(string path)
     {
+        LoadGeometry(path);
+        Geometry.Upload(Meshes, Options.Format);
+        for (const ModelNode &node : Nodes)
+        {
+            Graph.AddNode(node.Name, node.Parent, node.Transform);
+        }
+        Graph.Update();
+
+        // everything is on the GPU now, the CPU copies are only kept on request
+        if (!Options.KeepCpuGeometry)
+        {
+            for (Mesh &mesh : Meshes)
+            {
+                ReleasedGeometryBytes += mesh.GetCpuGeometrySize();
+                mesh.ReleaseCpuGeometry();
+            }
+        }
+    }
+
+    void LoadGeometry(const string &path)
+    {
+        // retrieve the directory path of the filepath
+        Directory = path.substr(0, path.find_last_of('/'));
+
+        // a valid cache skips assimp entirely, it is keyed on the contents of the source file and
+        // of the files it pulled in
+        uint64_t sourceHash = 0;
+        bool useCache = Options.UseMeshCache && HashFile(path, sourceHash);
+        string cachePath = path + MESH_CACHE_EXTENSION;
+        if (useCache && LoadFromCache(cachePath, sourceHash))
+        {
+            return;
+        }
+
         // read file via ASSIMP
+        vector<string> importedFiles;
         Assimp::Importer importer;
-        const aiScene *scene =
-            importer.ReadFile(path,
-                              aiProcess_Triangulate | aiProcess_GenSmoothNormals |
-                                  aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+        importer.SetIOHandler(new RecordingIOSystem(importedFiles)); // the importer deletes it
+        const aiScene *scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
         // check for errors
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
             !scene->mRootNode) // if is Not Zero
@@ -66,15 +423,51 @@ private:
             cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
             return;
         }
-        // retrieve the directory path of the filepath
-        Directory = path.substr(0, path.find_last_of('/'));
+
+        // decode every texture of every material at once before the meshes ask for them
+        vector<Texture> textures;
+        std::unordered_set<string> seenPaths;
+        for (unsigned int i = 0; i < scene->mNumMaterials; ++i)
+        {
+            for (const ModelTextureType &textureType : MODEL_TEXTURE_TYPES)
+            {
+                aiMaterial *material = scene->mMaterials[i];
+                for (unsigned int j = 0; j < material->GetTextureCount(textureType.Type); ++j)
+                {
+                    aiString str;
+                    material->GetTexture(textureType.Type, j, &str);
+                    if (seenPaths.insert(str.C_Str()).second)
+                    {
+                        textures.push_back(Texture{0, textureType.Name, str.C_Str()});
+                    }
+                }
+            }
+        }
+        PreloadTextures(textures);
+
+        // every mesh is built in place, reserving up front means they are never moved around
+        Meshes.reserve(CountNodeMeshes(scene->mRootNode));
 
         // process ASSIMP's root node recursively
-        ProcessNode(scene->mRootNode, scene);
+        ProcessNode(scene->mRootNode, scene, -1);
+        if (Options.OptimizeMeshes)
+        {
+            OptimizationReport.Print(path);
+        }
+
+        if (useCache)
+        {
+            WriteCache(cachePath, sourceHash, path, importedFiles);
+        }
     }
 
-    void ProcessNode(aiNode *node, const aiScene *scene)
+    void ProcessNode(aiNode *node, const aiScene *scene, int parent)
     {
+        // keep the node itself, its transform is needed to place the meshes it owns
+        int nodeIndex = static_cast<int>(Nodes.size());
+        Nodes.push_back(
+            ModelNode{node->mName.C_Str(), parent, ToGlmMatrix(node->mTransformation), {}});
+
         // process each mesh located at the current node
         for (unsigned int i = 0; i < node->mNumMeshes; i++)
         {
@@ -82,22 +475,253 @@ private:
             // the scene contains all the data, node is just to keep stuff organized (like relations
             // between nodes).
             aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-            Meshes.push_back(ProcessMesh(mesh, scene));
+            Nodes[nodeIndex].MeshIndices.push_back(static_cast<unsigned int>(Meshes.size()));
+            ProcessMesh(mesh, scene);
         }
         // after we've processed all of the meshes (if any) we then recursively process each of the
         // children nodes
         for (unsigned int i = 0; i < node->mNumChildren; i++)
         {
-            ProcessNode(node->mChildren[i], scene);
+            ProcessNode(node->mChildren[i], scene, nodeIndex);
+        }
+    }
+
+    unsigned int CountNodeMeshes(aiNode *node) const
+    {
+        unsigned int count = node->mNumMeshes;
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+        {
+            count += CountNodeMeshes(node->mChildren[i]);
         }
+        return count;
     }
 
-    Mesh ProcessMesh(aiMesh *mesh, const aiScene *scene)
+    /// <summary>
+    /// Rebuilds meshes, materials and nodes from a cache file written by an earlier import. Returns
+    /// false if there is no cache or it is stale, in which case the model is imported normally.
+    /// </summary>
+    bool LoadFromCache(const string &cachePath, uint64_t sourceHash)
+    {
+        MeshCacheReader cache;
+        if (!cache.Open(cachePath, sourceHash, MODEL_IMPORT_FLAGS, GetProcessingFlags()))
+        {
+            return false;
+        }
+        const MeshCacheHeader &header = cache.GetHeader();
+        if (!CheckCache(cache))
+        {
+            cout << "ERROR::MESH_CACHE:: Corrupt cache " << cachePath << endl;
+            return false;
+        }
+
+        // decode every texture of the cached materials at once
+        vector<Texture> textures;
+        std::unordered_set<string> seenPaths;
+        for (unsigned int i = 0; i < header.TextureCount; ++i)
+        {
+            const MeshCacheTexture &texture = cache.GetTexture(i);
+            string path = cache.GetString(texture.PathOffset, texture.PathLength);
+            if (seenPaths.insert(path).second)
+            {
+                string type = cache.GetString(texture.TypeOffset, texture.TypeLength);
+                textures.push_back(Texture{0, type, path});
+            }
+        }
+        PreloadTextures(textures);
+
+        // textures are looked up per material, the meshes then share them
+        vector<vector<Texture>> materials(header.MaterialCount);
+        for (unsigned int i = 0; i < header.MaterialCount; ++i)
+        {
+            const MeshCacheMaterial &material = cache.GetMaterial(i);
+            for (unsigned int j = 0; j < material.TextureCount; ++j)
+            {
+                const MeshCacheTexture &texture = cache.GetTexture(material.FirstTexture + j);
+                string path = cache.GetString(texture.PathOffset, texture.PathLength);
+                string type = cache.GetString(texture.TypeOffset, texture.TypeLength);
+                materials[i].push_back(LoadTexture(path.c_str(), type));
+            }
+        }
+
+        // vertex and index data is already processed, each mesh's range is copied out of the
+        // mapping as is into the vectors the mesh keeps until it is uploaded
+        Meshes.reserve(header.MeshCount);
+        for (unsigned int i = 0; i < header.MeshCount; ++i)
+        {
+            const MeshCacheMesh &entry = cache.GetMesh(i);
+            const Vertex *vertices = cache.GetVertices(entry);
+            const unsigned int *indices = cache.GetIndices(entry);
+            Meshes.emplace_back(vector<Vertex>(vertices, vertices + entry.VertexCount),
+                                vector<unsigned int>(indices, indices + entry.IndexCount),
+                                materials[entry.MaterialIndex],
+                                (entry.Flags & MESH_CACHE_FLAG_HAS_BONES) != 0);
+            Meshes.back().MaterialIndex = entry.MaterialIndex;
+            const MeshCacheLod *lods = cache.GetLods(entry);
+            Meshes.back().Lods.clear();
+            for (unsigned int j = 0; j < entry.LodCount; ++j)
+            {
+                Meshes.back().Lods.push_back(
+                    MeshLod{lods[j].FirstIndex, lods[j].IndexCount, lods[j].Error});
+            }
+            const MeshCacheMeshlet *meshlets = cache.GetMeshlets(entry);
+            for (unsigned int j = 0; j < entry.MeshletCount; ++j)
+            {
+                Meshlet meshlet;
+                meshlet.FirstIndex = meshlets[j].FirstIndex;
+                meshlet.IndexCount = meshlets[j].IndexCount;
+                std::memcpy(&meshlet.Center[0], meshlets[j].Center, sizeof(meshlets[j].Center));
+                meshlet.Radius = meshlets[j].Radius;
+                std::memcpy(
+                    &meshlet.ConeAxis[0], meshlets[j].ConeAxis, sizeof(meshlets[j].ConeAxis));
+                meshlet.ConeCutoff = meshlets[j].ConeCutoff;
+                Meshes.back().Meshlets.push_back(meshlet);
+            }
+        }
+
+        Nodes.reserve(header.NodeCount);
+        for (unsigned int i = 0; i < header.NodeCount; ++i)
+        {
+            const MeshCacheNode &entry = cache.GetNode(i);
+            const uint32_t *meshIndices = cache.GetNodeMeshes(entry);
+            ModelNode node;
+            node.Name = cache.GetString(entry.NameOffset, entry.NameLength);
+            node.Parent = entry.Parent;
+            std::memcpy(&node.Transform[0][0], entry.Transform, sizeof(entry.Transform));
+            node.MeshIndices.assign(meshIndices, meshIndices + entry.MeshCount);
+            Nodes.push_back(node);
+        }
+
+        // bones are stored in ID order
+        for (unsigned int i = 0; i < header.BoneCount; ++i)
+        {
+            const MeshCacheBone &entry = cache.GetBone(i);
+            BoneInfo bone;
+            bone.ID = static_cast<int>(i);
+            std::memcpy(&bone.Offset[0][0], entry.Offset, sizeof(entry.Offset));
+            BoneInfoMap.emplace(cache.GetString(entry.NameOffset, entry.NameLength), bone);
+        }
+        BoneCount = static_cast<int>(header.BoneCount);
+        return true;
+    }
+
+    /// <summary>
+    /// Checks every entry of an open cache before anything is loaded from it, so a corrupt or
+    /// hand edited file is imported again instead of read out of bounds.
+    /// </summary>
+    static bool CheckCache(const MeshCacheReader &cache)
+    {
+        const MeshCacheHeader &header = cache.GetHeader();
+        for (unsigned int i = 0; i < header.MeshCount; ++i)
+        {
+            if (!cache.CheckMesh(cache.GetMesh(i)))
+            {
+                return false;
+            }
+        }
+        for (unsigned int i = 0; i < header.MaterialCount; ++i)
+        {
+            if (!cache.CheckMaterial(cache.GetMaterial(i)))
+            {
+                return false;
+            }
+        }
+        for (unsigned int i = 0; i < header.TextureCount; ++i)
+        {
+            if (!cache.CheckTexture(cache.GetTexture(i)))
+            {
+                return false;
+            }
+        }
+        for (unsigned int i = 0; i < header.NodeCount; ++i)
+        {
+            if (!cache.CheckNode(cache.GetNode(i), i))
+            {
+                return false;
+            }
+        }
+        for (unsigned int i = 0; i < header.BoneCount; ++i)
+        {
+            if (!cache.CheckBone(cache.GetBone(i)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t GetProcessingFlags() const
+    {
+        uint32_t flags = 0;
+        if (Options.OptimizeMeshes)
+        {
+            flags |= MESH_CACHE_PROCESS_OPTIMIZED;
+        }
+        if (Options.GenerateLods)
+        {
+            flags |= MESH_CACHE_PROCESS_LODS;
+        }
+        if (Options.GenerateMeshlets)
+        {
+            flags |= MESH_CACHE_PROCESS_MESHLETS;
+        }
+        return flags;
+    }
+
+    void WriteCache(const string &cachePath,
+                    uint64_t sourceHash,
+                    const string &sourcePath,
+                    const vector<string> &importedFiles) const
+    {
+        MeshCacheWriter cache;
+        string source = std::filesystem::path(sourcePath).lexically_normal().generic_string();
+        for (const string &file : importedFiles)
+        {
+            uint64_t hash = 0;
+            string normalized = std::filesystem::path(file).lexically_normal().generic_string();
+            if (normalized != source && HashFile(file, hash))
+            {
+                cache.AddDependency(file, hash);
+            }
+        }
+        for (const Mesh &mesh : Meshes)
+        {
+            uint32_t flags = mesh.HasBones ? MESH_CACHE_FLAG_HAS_BONES : 0;
+            cache.AddMesh(
+                mesh.Vertices, mesh.Indices, mesh.Lods, mesh.Meshlets, mesh.MaterialIndex, flags);
+            cache.SetMaterial(mesh.MaterialIndex, mesh.Textures);
+        }
+        for (const ModelNode &node : Nodes)
+        {
+            cache.AddNode(node.Name, node.Parent, node.Transform, node.MeshIndices);
+        }
+        vector<const std::pair<const string, BoneInfo> *> bones(BoneCount);
+        for (const auto &bone : BoneInfoMap)
+        {
+            bones[bone.second.ID] = &bone;
+        }
+        for (const auto *bone : bones)
+        {
+            cache.AddBone(bone->first, bone->second.Offset);
+        }
+
+        if (!cache.Save(cachePath, sourceHash, MODEL_IMPORT_FLAGS, GetProcessingFlags()))
+        {
+            cout << "ERROR::MESH_CACHE:: Failed to write " << cachePath << endl;
+        }
+    }
+
+    /// <summary>
+    /// Extracts the data of an assimp mesh and adds it to Meshes. The buffers are sized once and
+    /// then moved into the new mesh, so the vertex data is never copied.
+    /// </summary>
+    void ProcessMesh(aiMesh *mesh, const aiScene *scene)
     {
         // data to fill
         vector<Vertex> vertices;
         vector<unsigned int> indices;
         vector<Texture> textures;
+        vertices.reserve(mesh->mNumVertices);
+        indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3); // triangulated on import
 
         // walk through each of the mesh's vertices
         for (unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -142,6 +766,12 @@ private:
             }
             else
                 vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+            // no bone influences until bones are read
+            for (int j = 0; j < MAX_BONE_INFLUENCE; j++)
+            {
+                vertex.BoneIDs[j] = -1;
+                vertex.Weights[j] = 0.0f;
+            }
 
             vertices.push_back(vertex);
         }
@@ -154,34 +784,166 @@ private:
             for (unsigned int j = 0; j < face.mNumIndices; j++)
                 indices.push_back(face.mIndices[j]);
         }
-        // process materials
+        // process materials, see MODEL_TEXTURE_TYPES for the sampler naming convention
         aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
-        // we assume a convention for sampler names in the shaders. Each diffuse texture should be
-        // named as 'texture_diffuseN' where N is a sequential number ranging from 1 to
-        // MAX_SAMPLER_NUMBER. Same applies to other texture as the following list summarizes:
-        // diffuse: texture_diffuseN
-        // specular: texture_specularN
-        // normal: texture_normalN
-
-        // 1. diffuse maps
-        vector<Texture> diffuseMaps =
-            LoadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-        // 2. specular maps
-        vector<Texture> specularMaps =
-            LoadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-        // 3. normal maps
-        std::vector<Texture> normalMaps =
-            LoadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-        // 4. height maps
-        std::vector<Texture> heightMaps =
-            LoadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-        // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        for (const ModelTextureType &textureType : MODEL_TEXTURE_TYPES)
+        {
+            vector<Texture> maps =
+                LoadMaterialTextures(material, textureType.Type, textureType.Name);
+            textures.insert(textures.end(), maps.begin(), maps.end());
+        }
+
+        // bone weights have to be in place before the vertices get reordered
+        ExtractBoneWeights(vertices, mesh);
+        if (Options.OptimizeMeshes)
+        {
+            OptimizeMesh(vertices, indices, OptimizationReport);
+        }
+        // meshlets only reorder the full level, the simplified ones are appended after it
+        vector<Meshlet> meshlets;
+        if (Options.GenerateMeshlets)
+        {
+            meshlets = BuildMeshlets(vertices, indices, indices.size());
+        }
+        vector<MeshLod> lods;
+        if (Options.GenerateLods)
+        {
+            lods = GenerateLods(vertices, indices);
+        }
+
+        // create the mesh object in place from the extracted mesh data
+        Meshes.emplace_back(std::move(vertices),
+                            std::move(indices),
+                            std::move(textures),
+                            mesh->HasBones());
+        Meshes.back().MaterialIndex = mesh->mMaterialIndex;
+        if (!lods.empty())
+        {
+            Meshes.back().Lods = std::move(lods);
+        }
+        Meshes.back().Meshlets = std::move(meshlets);
+    }
+
+    /// <summary>
+    /// Simplifies a mesh into up to MESH_LOD_COUNT levels, each aiming for half the triangles of
+    /// the one before, and appends their indices after the full mesh's. Every level is simplified
+    /// from the full mesh, so its error is measured against the original surface.
+    /// </summary>
+    static vector<MeshLod> GenerateLods(const vector<Vertex> &vertices,
+                                        vector<unsigned int> &indices)
+    {
+        vector<MeshLod> lods;
+        lods.push_back(MeshLod{0, static_cast<unsigned int>(indices.size()), 0.0f});
+        if (vertices.empty() || indices.empty())
+        {
+            return lods;
+        }
+
+        // the error bound follows the size of the mesh, so small and large meshes lose alike
+        glm::vec3 boundsMin = vertices[0].Position;
+        glm::vec3 boundsMax = vertices[0].Position;
+        for (const Vertex &vertex : vertices)
+        {
+            boundsMin = glm::min(boundsMin, vertex.Position);
+            boundsMax = glm::max(boundsMax, vertex.Position);
+        }
+        float maxError = MESH_LOD_MAX_ERROR * glm::length(boundsMax - boundsMin) * 0.5f;
+
+        size_t fullCount = indices.size();
+        size_t previousCount = fullCount;
+        for (unsigned int level = 1; level < MESH_LOD_COUNT; ++level)
+        {
+            vector<unsigned int> fullIndices(indices.begin(), indices.begin() + fullCount);
+            size_t target = (previousCount / 2) / 3 * 3;
+            float error = 0.0f;
+            vector<unsigned int> lod =
+                SimplifyMesh(vertices, fullIndices, target, maxError, &error);
+            if (lod.empty() || lod.size() > previousCount * MESH_LOD_MIN_REDUCTION)
+            {
+                break; // the error bound or the locked seams allow no further reduction
+            }
+            OptimizeVertexCache(lod, vertices.size());
+
+            lods.push_back(MeshLod{static_cast<unsigned int>(indices.size()),
+                                   static_cast<unsigned int>(lod.size()),
+                                   error});
+            indices.insert(indices.end(), lod.begin(), lod.end());
+            previousCount = lod.size();
+        }
+        return lods;
+    }
+
+    /// <summary>
+    /// Fills in the bone influences of a mesh's vertices, registering bones no earlier mesh used.
+    /// Each vertex keeps its MAX_BONE_INFLUENCE strongest weights, scaled to add up to one.
+    /// </summary>
+    void ExtractBoneWeights(vector<Vertex> &vertices, aiMesh *mesh)
+    {
+        if (mesh->mNumBones == 0)
+        {
+            return;
+        }
+
+        for (unsigned int i = 0; i < mesh->mNumBones; ++i)
+        {
+            aiBone *bone = mesh->mBones[i];
+            auto it = BoneInfoMap.find(bone->mName.C_Str());
+            if (it == BoneInfoMap.end())
+            {
+                BoneInfo info{BoneCount++, ToGlmMatrix(bone->mOffsetMatrix)};
+                it = BoneInfoMap.emplace(bone->mName.C_Str(), info).first;
+                if (BoneCount == MAX_BONES + 1)
+                {
+                    cout << "ERROR::MODEL:: More than " << MAX_BONES << " bones in "
+                         << Directory << ", the skinning shaders ignore the rest" << endl;
+                }
+            }
+            for (unsigned int j = 0; j < bone->mNumWeights; ++j)
+            {
+                const aiVertexWeight &weight = bone->mWeights[j];
+                AddBoneInfluence(vertices[weight.mVertexId], it->second.ID, weight.mWeight);
+            }
+        }
+
+        for (Vertex &vertex : vertices)
+        {
+            float total = 0.0f;
+            for (int j = 0; j < MAX_BONE_INFLUENCE; ++j)
+            {
+                total += vertex.Weights[j];
+            }
+            for (int j = 0; total > 0.0f && j < MAX_BONE_INFLUENCE; ++j)
+            {
+                vertex.Weights[j] /= total;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Puts a bone into a free influence slot of the vertex, or in place of its weakest bone if
+    /// the new one is stronger.
+    /// </summary>
+    static void AddBoneInfluence(Vertex &vertex, int boneID, float weight)
+    {
+        int weakest = 0;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; ++i)
+        {
+            if (vertex.BoneIDs[i] < 0)
+            {
+                vertex.BoneIDs[i] = boneID;
+                vertex.Weights[i] = weight;
+                return;
+            }
+            if (vertex.Weights[i] < vertex.Weights[weakest])
+            {
+                weakest = i;
+            }
+        }
+        if (weight > vertex.Weights[weakest])
+        {
+            vertex.BoneIDs[weakest] = boneID;
+            vertex.Weights[weakest] = weight;
+        }
     }
 
     /// <summary>
@@ -195,57 +957,144 @@ private:
         {
             aiString str;
             mat->GetTexture(type, i, &str);
-            // check if texture was loaded before and if so, continue to next iteration: skip
-            // loading a new texture
-            bool skip = false;
-            for (unsigned int j = 0; j < LoadedTextures.size(); j++)
+            textures.push_back(LoadTexture(str.C_Str(), typeName));
+        }
+        return textures;
+    }
+
+    /// <summary>
+    /// Returns the texture at the given path relative to the model. It is only loaded if neither
+    /// this model nor any other model has loaded it before.
+    /// </summary>
+    Texture LoadTexture(const char *path, const string &typeName)
+    {
+        auto it = LoadedTextureIndices.find(path);
+        if (it == LoadedTextureIndices.end())
+        {
+            string key = TextureCache::MakeKey(Directory + '/' + path, ShouldGammaCorrect);
+            unsigned int id = TextureCache::Get().Acquire(key);
+            if (id == 0)
             {
-                if (std::strcmp(LoadedTextures[j].Path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(LoadedTextures[j]);
-                    skip = true; // a texture with the same filepath has already been loaded,
-                                 // continue to next one. (optimization)
-                    break;
-                }
+                id = TextureFromFile(path, this->Directory, ShouldGammaCorrect);
+                TextureCache::Get().Add(key, id);
+            }
+            it = AddLoadedTexture(Texture{id, typeName, path});
+        }
+
+        Texture texture = LoadedTextures[it->second];
+        texture.Type = typeName;
+        return texture;
+    }
+
+    /// <summary>
+    /// Loads the given textures (Path and Type set) that aren't loaded yet. The image files are
+    /// decoded concurrently, which dominates the cost, then uploaded one by one on this thread
+    /// since it owns the GL context. Textures another model already loaded are shared instead.
+    /// </summary>
+    void PreloadTextures(const vector<Texture> &textures)
+    {
+        vector<Texture> pending;
+        vector<string> pendingKeys;
+        for (const Texture &texture : textures)
+        {
+            if (LoadedTextureIndices.count(texture.Path) > 0)
+            {
+                continue;
             }
-            if (!skip)
-            { // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.ID = TextureFromFile(str.C_Str(), this->Directory, ShouldGammaCorrect);
-                texture.Type = typeName;
-                texture.Path = str.C_Str();
-                textures.push_back(texture);
-                LoadedTextures.push_back(
-                    texture); // store it as texture loaded for entire model, to ensure we won't
-                              // unnecessary load duplicate textures.
+
+            string key = TextureCache::MakeKey(Directory + '/' + texture.Path, ShouldGammaCorrect);
+            unsigned int id = TextureCache::Get().Acquire(key);
+            if (id != 0)
+            {
+                AddLoadedTexture(Texture{id, texture.Type, texture.Path});
+            }
+            else
+            {
+                pending.push_back(texture);
+                pendingKeys.push_back(key);
             }
         }
-        return textures;
+
+        vector<DecodedImage> images(pending.size());
+        auto decode = [&](size_t i) {
+            images[i] = DecodeImage(pending[i].Path.c_str(), Directory);
+        };
+        if (Options.ParallelTextureDecode)
+        {
+            // one image per job, their sizes vary too much to batch them
+            JobSystem::Get().ParallelFor(pending.size(), 1, decode);
+        }
+        else
+        {
+            for (size_t i = 0; i < pending.size(); ++i)
+            {
+                decode(i);
+            }
+        }
+
+        for (size_t i = 0; i < pending.size(); ++i)
+        {
+            pending[i].ID = UploadTexture(images[i], pending[i].Path.c_str(), ShouldGammaCorrect);
+            TextureCache::Get().Add(pendingKeys[i], pending[i].ID);
+            AddLoadedTexture(pending[i]);
+        }
+    }
+
+    std::unordered_map<string, size_t>::iterator AddLoadedTexture(const Texture &texture)
+    {
+        LoadedTextures.push_back(texture);
+        return LoadedTextureIndices.emplace(texture.Path, LoadedTextures.size() - 1).first;
     }
 };
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma)
+{
+    DecodedImage image = DecodeImage(path, directory);
+    return UploadTexture(image, path, gamma);
+}
+
+/// <summary>
+/// Reads and decodes an image file relative to directory. Doesn't touch GL, so it is safe to call
+/// from any thread.
+/// </summary>
+DecodedImage DecodeImage(const char *path, const string &directory)
 {
     string fileName = string(path);
     fileName = directory + '/' + fileName;
 
+    DecodedImage image;
+    image.Data = stbi_load(fileName.c_str(), &image.Width, &image.Height, &image.NumChannels, 0);
+    return image;
+}
+
+/// <summary>
+/// Creates a texture from a decoded image and frees the pixels. Must run on the GL thread.
+/// </summary>
+unsigned int UploadTexture(DecodedImage &image, const char *path, bool gamma)
+{
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, numChannels;
-    unsigned char *data = stbi_load(fileName.c_str(), &width, &height, &numChannels, 0);
-    if (data)
+    if (image.Data)
     {
         GLenum format;
-        if (numChannels == 1)
+        if (image.NumChannels == 1)
             format = GL_RED;
-        else if (numChannels == 3)
+        else if (image.NumChannels == 3)
             format = GL_RGB;
-        else if (numChannels == 4)
+        else if (image.NumChannels == 4)
             format = GL_RGBA;
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D,
+                     0,
+                     format,
+                     image.Width,
+                     image.Height,
+                     0,
+                     format,
+                     GL_UNSIGNED_BYTE,
+                     image.Data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -253,15 +1102,32 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        stbi_image_free(data);
+        stbi_image_free(image.Data);
     }
     else
     {
         std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        stbi_image_free(image.Data);
     }
+    image.Data = nullptr;
 
     return textureID;
 }
 
+/// <summary>
+/// Converts an assimp matrix, which is row major, to a column major glm matrix.
+/// </summary>
+glm::mat4 ToGlmMatrix(const aiMatrix4x4 &matrix)
+{
+    glm::mat4 result;
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result[column][row] = static_cast<float>(matrix[row][column]);
+        }
+    }
+    return result;
+}
+
 #endif
\ No newline at end of file
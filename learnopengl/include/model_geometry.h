@@ -0,0 +1,211 @@
+#ifndef MODEL_GEOMETRY_H
+#define MODEL_GEOMETRY_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <utility>
+#include <vector>
+
+#include <frame_stats.h>
+#include <mesh.h>
+#include <vertex_format.h>
+
+using std::vector;
+
+/// <summary>
+/// The GPU buffers of a whole model. Every mesh is packed into one vertex buffer and one index
+/// buffer behind a single vertex array, each mesh then only remembers its range and is drawn with
+/// glDrawElementsBaseVertex. Indices stay relative to their own mesh, the base vertex offsets them.
+/// </summary>
+struct ModelGeometry
+{
+public:
+    VertexLayout Layout;
+    size_t VertexBufferSize = 0; // bytes
+    size_t IndexBufferSize = 0;  // bytes
+
+    ModelGeometry() = default;
+
+    ~ModelGeometry()
+    {
+        Release();
+    }
+
+    // owns GL objects, so it can be moved but not copied
+    ModelGeometry(const ModelGeometry &) = delete;
+    ModelGeometry &operator=(const ModelGeometry &) = delete;
+
+    ModelGeometry(ModelGeometry &&other) noexcept
+        : Layout(other.Layout),
+          VertexBufferSize(other.VertexBufferSize),
+          IndexBufferSize(other.IndexBufferSize),
+          VAO(std::exchange(other.VAO, 0)),
+          VBO(std::exchange(other.VBO, 0)),
+          EBO(std::exchange(other.EBO, 0)),
+          InstanceVBO(std::exchange(other.InstanceVBO, 0)),
+          InstanceCapacity(std::exchange(other.InstanceCapacity, 0))
+    {
+    }
+
+    ModelGeometry &operator=(ModelGeometry &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            Layout = other.Layout;
+            VertexBufferSize = other.VertexBufferSize;
+            IndexBufferSize = other.IndexBufferSize;
+            VAO = std::exchange(other.VAO, 0);
+            VBO = std::exchange(other.VBO, 0);
+            EBO = std::exchange(other.EBO, 0);
+            InstanceVBO = std::exchange(other.InstanceVBO, 0);
+            InstanceCapacity = std::exchange(other.InstanceCapacity, 0);
+        }
+        return *this;
+    }
+
+    /// <summary>
+    /// Uploads the vertices and indices of all meshes and assigns each mesh its range. All meshes
+    /// share one layout, so Compact is only used when every mesh fits it.
+    /// </summary>
+    void Upload(vector<Mesh> &meshes, VertexFormat format)
+    {
+        Release();
+        if (meshes.empty())
+        {
+            return;
+        }
+
+        Layout = ChooseVertexLayout(meshes[0].Vertices, format, meshes[0].HasBones);
+        size_t vertexCount = 0;
+        for (Mesh &mesh : meshes)
+        {
+            Layout = MergeVertexLayouts(
+                Layout, ChooseVertexLayout(mesh.Vertices, format, mesh.HasBones));
+            mesh.BaseVertex = static_cast<int>(vertexCount);
+            vertexCount += mesh.Vertices.size();
+
+            // 16 and 32 bit ranges share the index buffer, each starts aligned to its index size
+            size_t indexSize = mesh.GetIndexSize();
+            IndexBufferSize = (IndexBufferSize + indexSize - 1) / indexSize * indexSize;
+            mesh.FirstIndex = static_cast<unsigned int>(IndexBufferSize / indexSize);
+            IndexBufferSize += mesh.Indices.size() * indexSize;
+        }
+        VertexBufferSize = vertexCount * Layout.Stride;
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, VertexBufferSize, NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexBufferSize, NULL, GL_STATIC_DRAW);
+
+        // fill the buffers one mesh at a time, so only one mesh is ever quantized at once
+        for (Mesh &mesh : meshes)
+        {
+            mesh.Layout = Layout;
+            size_t vertexOffset = static_cast<size_t>(mesh.BaseVertex) * Layout.Stride;
+            if (Layout.Format == VertexFormat::Compact)
+            {
+                vector<unsigned char> compact = EncodeCompactVertices(mesh.Vertices, Layout);
+                glBufferSubData(GL_ARRAY_BUFFER, vertexOffset, compact.size(), compact.data());
+            }
+            else
+            {
+                glBufferSubData(GL_ARRAY_BUFFER,
+                                vertexOffset,
+                                mesh.Vertices.size() * sizeof(Vertex),
+                                mesh.Vertices.data());
+            }
+            size_t indexOffset = mesh.FirstIndex * mesh.GetIndexSize();
+            if (mesh.IndexType == GL_UNSIGNED_SHORT)
+            {
+                vector<unsigned short> shortIndices(mesh.Indices.begin(), mesh.Indices.end());
+                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                                indexOffset,
+                                shortIndices.size() * sizeof(unsigned short),
+                                shortIndices.data());
+            }
+            else
+            {
+                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                                indexOffset,
+                                mesh.Indices.size() * sizeof(unsigned int),
+                                mesh.Indices.data());
+            }
+        }
+
+        // set the vertex attribute pointers to match the layout
+        SetupVertexAttributes(Layout);
+        glBindVertexArray(0);
+    }
+
+    /// <summary>
+    /// Uploads the model matrices for the next instanced draw. The instance buffer and its
+    /// attributes are created on first use, after that it only grows, and each upload orphans the
+    /// old contents so the driver doesn't wait for draws still reading them.
+    /// </summary>
+    void SetInstanceTransforms(const glm::mat4 *transforms, size_t count)
+    {
+        if (InstanceVBO == 0)
+        {
+            glGenBuffers(1, &InstanceVBO);
+            glBindVertexArray(VAO);
+            glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+            SetupInstanceAttributes();
+            glBindVertexArray(0);
+        }
+        else
+        {
+            glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+        }
+
+        InstanceCapacity = count > InstanceCapacity ? count : InstanceCapacity;
+        glBufferData(GL_ARRAY_BUFFER, InstanceCapacity * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), transforms);
+    }
+
+    /// <summary>
+    /// Binds the vertex array, after which any mesh of the model can be drawn.
+    /// </summary>
+    void Bind() const
+    {
+        glBindVertexArray(VAO);
+        ++frameStats.VertexArrayBinds;
+    }
+
+    unsigned int GetVertexArray() const
+    {
+        return VAO;
+    }
+
+    bool IsUploaded() const
+    {
+        return VAO != 0;
+    }
+
+private:
+    unsigned int VAO = 0; // Vertex Array Object
+    unsigned int VBO = 0; // Vertex Buffer Object
+    unsigned int EBO = 0; // Element Buffer Object
+    unsigned int InstanceVBO = 0; // per instance model matrices, see SetInstanceTransforms
+    size_t InstanceCapacity = 0;  // in instances
+
+    void Release()
+    {
+        // moved-from geometry holds zeroes, which GL ignores
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteBuffers(1, &InstanceVBO);
+        VAO = VBO = EBO = InstanceVBO = 0;
+        InstanceCapacity = 0;
+        VertexBufferSize = IndexBufferSize = 0;
+    }
+};
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef POSE_MATH_H
+#define POSE_MATH_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+
+// x64 always has SSE2, 32 bit x86 only when the compiler targets it
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__) ||                                 \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define POSE_MATH_SSE
+#include <emmintrin.h>
+#endif
+
+// Math for evaluating poses, which is dominated by many small matrix products and quaternion
+// blends. With SSE2 every column and every quaternion is one register, without it the functions
+// fall back to glm.
+
+/// <summary>
+/// Returns a * b, building each column of the result from the four columns of a at once.
+/// </summary>
+inline glm::mat4 MultiplyTransforms(const glm::mat4 &a, const glm::mat4 &b)
+{
+#ifdef POSE_MATH_SSE
+    __m128 a0 = _mm_loadu_ps(&a[0][0]);
+    __m128 a1 = _mm_loadu_ps(&a[1][0]);
+    __m128 a2 = _mm_loadu_ps(&a[2][0]);
+    __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+    glm::mat4 result;
+    for (int column = 0; column < 4; ++column)
+    {
+        __m128 x = _mm_mul_ps(a0, _mm_set1_ps(b[column][0]));
+        __m128 y = _mm_mul_ps(a1, _mm_set1_ps(b[column][1]));
+        __m128 z = _mm_mul_ps(a2, _mm_set1_ps(b[column][2]));
+        __m128 w = _mm_mul_ps(a3, _mm_set1_ps(b[column][3]));
+        _mm_storeu_ps(&result[column][0], _mm_add_ps(_mm_add_ps(x, y), _mm_add_ps(z, w)));
+    }
+    return result;
+#else
+    return a * b;
+#endif
+}
+
+/// <summary>
+/// Spherical interpolation between two unit quaternions along the shorter arc. Nearly equal
+/// rotations are blended linearly instead, where slerp would divide by almost zero. The result is
+/// normalized.
+/// </summary>
+inline glm::quat SlerpRotations(const glm::quat &a, const glm::quat &b, float t)
+{
+    // the blend works on all four components alike, so the storage order of glm doesn't matter
+#ifdef POSE_MATH_SSE
+    __m128 qa = _mm_loadu_ps(&a[0]);
+    __m128 qb = _mm_loadu_ps(&b[0]);
+    __m128 products = _mm_mul_ps(qa, qb);
+    products = _mm_add_ps(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 3, 0, 1)));
+    products = _mm_add_ps(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 0, 3, 2)));
+    float cosine = _mm_cvtss_f32(products);
+#else
+    float cosine = glm::dot(a, b);
+#endif
+
+    // q and -q are the same rotation, flipping one keeps to the shorter arc
+    float sign = cosine < 0.0f ? -1.0f : 1.0f;
+    cosine *= sign;
+
+    float weightA = 1.0f - t;
+    float weightB = t;
+    if (cosine < 0.9995f)
+    {
+        float angle = std::acos(cosine);
+        float inverseSine = 1.0f / std::sin(angle);
+        weightA = std::sin(weightA * angle) * inverseSine;
+        weightB = std::sin(weightB * angle) * inverseSine;
+    }
+    weightB *= sign;
+
+#ifdef POSE_MATH_SSE
+    __m128 blend = _mm_add_ps(_mm_mul_ps(qa, _mm_set1_ps(weightA)),
+                              _mm_mul_ps(qb, _mm_set1_ps(weightB)));
+    __m128 squares = _mm_mul_ps(blend, blend);
+    squares = _mm_add_ps(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(2, 3, 0, 1)));
+    squares = _mm_add_ps(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    glm::quat result;
+    _mm_storeu_ps(&result[0], _mm_div_ps(blend, _mm_sqrt_ps(squares)));
+    return result;
+#else
+    return glm::normalize(a * weightA + b * weightB);
+#endif
+}
+
+/// <summary>
+/// Builds translate(position) * rotation * scale(scale) directly, without the two full matrix
+/// products.
+/// </summary>
+inline glm::mat4 ComposeTransform(const glm::vec3 &position,
+                                  const glm::quat &rotation,
+                                  const glm::vec3 &scale)
+{
+    glm::mat3 basis = glm::mat3_cast(rotation);
+    glm::mat4 transform;
+    transform[0] = glm::vec4(basis[0] * scale.x, 0.0f);
+    transform[1] = glm::vec4(basis[1] * scale.y, 0.0f);
+    transform[2] = glm::vec4(basis[2] * scale.z, 0.0f);
+    transform[3] = glm::vec4(position, 1.0f);
+    return transform;
+}
+
+#endif
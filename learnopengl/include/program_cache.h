@@ -0,0 +1,244 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gl_ext.h>
+
+using std::string;
+using std::vector;
+
+// Bump whenever the layout of the file or the way keys are made changes, old binaries are then
+// recompiled.
+const uint32_t PROGRAM_CACHE_VERSION = 1;
+const char PROGRAM_CACHE_MAGIC[8] = {'L', 'O', 'G', 'L', 'P', 'R', 'O', 'G'};
+const char *const PROGRAM_CACHE_DIRECTORY = "shader_cache";
+const char *const PROGRAM_CACHE_EXTENSION = ".progbin";
+
+// A cache file is this header followed by the driver's binary of the linked program.
+struct ProgramCacheHeader
+{
+    char Magic[8];
+    uint32_t Version;
+    uint32_t Format; // binaryFormat returned by glGetProgramBinary
+    uint64_t Key;    // repeated so a file that was renamed or copied over is still rejected
+    uint64_t Length; // bytes of the binary after the header
+};
+
+/// <summary>
+/// How the programs of this run were built and what it cost, to compare a cold start that compiles
+/// every program against a warm one that restores them from the cache.
+/// </summary>
+struct ShaderLoadStats
+{
+public:
+    // programs compiled and linked from source, and the milliseconds spent doing so
+    unsigned int ProgramsCompiled = 0;
+    double CompileMilliseconds = 0.0;
+    // programs restored from a cached binary, reading the file included
+    unsigned int ProgramsLoaded = 0;
+    double LoadMilliseconds = 0.0;
+    // cached binaries the driver refused, after a driver update for example, and recompiled
+    unsigned int BinariesRejected = 0;
+    // programs swapped for a rebuild of their edited sources, and rebuilds that failed
+    unsigned int ProgramsReloaded = 0;
+    unsigned int ReloadsFailed = 0;
+
+    void Print() const
+    {
+        std::cout << "SHADER_CACHE:: compiled: " << ProgramsCompiled << " in "
+                  << CompileMilliseconds << " ms | from cache: " << ProgramsLoaded << " in "
+                  << LoadMilliseconds << " ms | rejected: " << BinariesRejected
+                  << " | reloaded: " << ProgramsReloaded << " | failed reloads: " << ReloadsFailed
+                  << std::endl;
+    }
+};
+
+// the stats of every Shader built so far
+inline ShaderLoadStats shaderLoadStats;
+
+/// <summary>
+/// Stores linked programs on disk as driver binaries, so later runs skip compiling and linking.
+/// Binaries are keyed by a hash of every stage's source, the defines they were built with and the
+/// vendor, renderer and version strings of the driver; a binary of another driver or of edited
+/// sources is never found. When the context can't retrieve program binaries nothing is stored and
+/// every lookup misses.
+/// </summary>
+struct ProgramBinaryCache
+{
+public:
+    // set to false to always compile, e.g. to measure a cold start
+    bool Enabled = true;
+
+    static ProgramBinaryCache &Get()
+    {
+        static ProgramBinaryCache instance;
+        return instance;
+    }
+
+    bool IsAvailable() const
+    {
+        return Enabled && GLExtensions::Get().HasProgramBinary;
+    }
+
+    /// <summary>
+    /// Hashes the sources of all stages in order, with an empty string for a missing stage, and
+    /// the defines injected into them, together with the current driver.
+    /// </summary>
+    uint64_t MakeKey(const vector<string> &sources, const string &defines = "")
+    {
+        uint64_t hash = GetDriverHash();
+        for (const string &source : sources)
+        {
+            hash = Hash(hash, source);
+            hash = Hash(hash, string(1, '\0')); // keeps "ab" + "c" apart from "a" + "bc"
+        }
+        return Hash(hash, defines);
+    }
+
+    /// <summary>
+    /// Restores the cached binary for key into program. Returns false when there is none or the
+    /// driver rejects it, the program is then left unlinked and can be built from source.
+    /// </summary>
+    bool Load(uint64_t key, unsigned int program)
+    {
+        if (!IsAvailable())
+        {
+            return false;
+        }
+        std::ifstream file(GetPath(key), std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        ProgramCacheHeader header;
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            std::memcmp(header.Magic, PROGRAM_CACHE_MAGIC, sizeof(header.Magic)) != 0 ||
+            header.Version != PROGRAM_CACHE_VERSION || header.Key != key)
+        {
+            return false;
+        }
+        vector<char> binary(header.Length);
+        if (!file.read(binary.data(), static_cast<std::streamsize>(binary.size())))
+        {
+            return false;
+        }
+
+        GLExtensions::Get().ProgramBinary(
+            program, header.Format, binary.data(), static_cast<GLsizei>(binary.size()));
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            ++shaderLoadStats.BinariesRejected;
+            return false;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Asks the driver to keep the binary of program retrievable, call it before linking.
+    /// </summary>
+    void PrepareForSave(unsigned int program) const
+    {
+        if (IsAvailable())
+        {
+            GLExtensions::Get().ProgramParameteri(
+                program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+    }
+
+    /// <summary>
+    /// Writes the binary of the linked program under key.
+    /// </summary>
+    void Save(uint64_t key, unsigned int program)
+    {
+        if (!IsAvailable())
+        {
+            return;
+        }
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+        {
+            return;
+        }
+        vector<char> binary(static_cast<size_t>(length));
+        GLsizei written = 0;
+        GLenum format = 0;
+        GLExtensions::Get().GetProgramBinary(program, length, &written, &format, binary.data());
+        if (written <= 0)
+        {
+            return;
+        }
+
+        ProgramCacheHeader header = {};
+        std::memcpy(header.Magic, PROGRAM_CACHE_MAGIC, sizeof(header.Magic));
+        header.Version = PROGRAM_CACHE_VERSION;
+        header.Format = format;
+        header.Key = key;
+        header.Length = static_cast<uint64_t>(written);
+
+        std::error_code error;
+        std::filesystem::create_directories(PROGRAM_CACHE_DIRECTORY, error);
+        string path = GetPath(key);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(binary.data(), written);
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER_CACHE:: Failed to write " << path << std::endl;
+            file.close();
+            std::remove(path.c_str()); // a torn file would only be rejected on every start
+        }
+    }
+
+private:
+    bool HasDriverHash = false;
+    uint64_t DriverHash = 0;
+
+    static uint64_t Hash(uint64_t hash, const string &text)
+    {
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    uint64_t GetDriverHash()
+    {
+        if (!HasDriverHash)
+        {
+            DriverHash = 14695981039346656037ull;
+            for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+            {
+                const char *value = reinterpret_cast<const char *>(glGetString(name));
+                DriverHash = Hash(DriverHash, value != nullptr ? value : "");
+                DriverHash = Hash(DriverHash, string(1, '\0'));
+            }
+            HasDriverHash = true;
+        }
+        return DriverHash;
+    }
+
+    static string GetPath(uint64_t key)
+    {
+        char name[17];
+        std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+        return string(PROGRAM_CACHE_DIRECTORY) + "/" + name + PROGRAM_CACHE_EXTENSION;
+    }
+};
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include <frame_stats.h>
+#include <frustum.h>
+#include <lod_selector.h>
+#include <material.h>
+#include <mesh.h>
+#include <meshlet_culler.h>
+#include <shader.h>
+
+using std::vector;
+
+enum class RenderPass
+{
+    Opaque = 0,
+    Transparent = 1, // drawn back to front after everything opaque
+    Overlay = 2,     // debug views drawn last, like the normal visualization
+};
+
+// Bits of each field in a sort key, from the most significant field down. Opaque draws sort by
+// state to change as little as possible and only then front to back:
+//
+//   [pass 4][shader 12][material 16][vertex array 12][depth 20]
+//
+// Transparent draws have to be back to front, so the inverted depth moves right after the pass:
+//
+//   [pass 4][inverted depth 20][shader 12][material 16][vertex array 12]
+const int SORT_KEY_PASS_BITS = 4;
+const int SORT_KEY_SHADER_BITS = 12;
+const int SORT_KEY_MATERIAL_BITS = 16;
+const int SORT_KEY_VERTEX_ARRAY_BITS = 12;
+const int SORT_KEY_DEPTH_BITS = 20;
+
+/// <summary>
+/// Builds the sort key of a draw, depth is the view space distance scaled to [0, 1].
+/// </summary>
+inline uint64_t MakeSortKey(RenderPass pass,
+                            unsigned int shader,
+                            unsigned int material,
+                            unsigned int vertexArray,
+                            float depth)
+{
+    auto field = [](uint64_t value, int bits) { return value & ((uint64_t(1) << bits) - 1); };
+
+    float clamped = depth < 0.0f ? 0.0f : (depth > 1.0f ? 1.0f : depth);
+    uint64_t maxDepth = (uint64_t(1) << SORT_KEY_DEPTH_BITS) - 1;
+    uint64_t quantized = static_cast<uint64_t>(clamped * maxDepth);
+
+    uint64_t state = field(shader, SORT_KEY_SHADER_BITS);
+    state = (state << SORT_KEY_MATERIAL_BITS) | field(material, SORT_KEY_MATERIAL_BITS);
+    state = (state << SORT_KEY_VERTEX_ARRAY_BITS) | field(vertexArray, SORT_KEY_VERTEX_ARRAY_BITS);
+
+    uint64_t key = field(static_cast<uint64_t>(pass), SORT_KEY_PASS_BITS);
+    if (pass == RenderPass::Transparent)
+    {
+        key = (key << SORT_KEY_DEPTH_BITS) | (maxDepth - quantized);
+        key = (key << (64 - SORT_KEY_PASS_BITS - SORT_KEY_DEPTH_BITS)) | state;
+    }
+    else
+    {
+        key = (key << (64 - SORT_KEY_PASS_BITS - SORT_KEY_DEPTH_BITS)) | state;
+        key = (key << SORT_KEY_DEPTH_BITS) | quantized;
+    }
+    return key;
+}
+
+/// <summary>
+/// Collects the draws of a frame, culls them against the view frustum, sorts them by their keys
+/// and issues them, skipping every program, texture, vertex array and transform change that would
+/// set what is already set. The camera uniforms of each shader are still set by the caller before
+/// Flush. With a LodSelector set, each mesh is drawn at the level of detail it picks, and with
+/// meshlet culling on, meshes drawn at full detail only draw their visible meshlets.
+/// </summary>
+struct RenderQueue
+{
+public:
+    /// <summary>
+    /// Clears the queue for a new frame. Draws outside the camera's frustum are dropped and the
+    /// rest are sorted by their distance along the view.
+    /// </summary>
+    void Begin(const glm::mat4 &projection, const glm::mat4 &view, float farPlane)
+    {
+        Commands.clear();
+        Transforms.clear();
+        Culler.Clear();
+        View = view;
+        FarPlane = farPlane;
+        ViewFrustum = Frustum::FromMatrix(projection * view);
+        Clusters.SetCamera(ViewFrustum, glm::vec3(glm::inverse(view)[3]));
+    }
+
+    /// <summary>
+    /// Picks the level of detail of every following submit, nullptr draws full detail. The
+    /// selector has to stay alive and its camera up to date while it is set.
+    /// </summary>
+    void SetLodSelector(const LodSelector *selector)
+    {
+        Lods = selector;
+    }
+
+    /// <summary>
+    /// Culls the meshlets of every visible mesh that has them before drawing it. Costs CPU time per
+    /// meshlet, it pays off for dense meshes that are partly off screen or facing away.
+    /// </summary>
+    void SetMeshletCulling(bool enabled)
+    {
+        CullMeshlets = enabled;
+    }
+
+    /// <summary>
+    /// Stores a transform for the following submits and returns its index.
+    /// </summary>
+    unsigned int AddTransform(const glm::mat4 &transform)
+    {
+        Transforms.push_back(transform);
+        return static_cast<unsigned int>(Transforms.size() - 1);
+    }
+
+    /// <summary>
+    /// Queues a mesh. The vertex array has to be the one holding the mesh's range.
+    /// </summary>
+    void Submit(RenderPass pass,
+                Shader &shader,
+                const Mesh &mesh,
+                unsigned int vertexArray,
+                unsigned int transform)
+    {
+        glm::vec3 center = (mesh.BoundsMin + mesh.BoundsMax) * 0.5f;
+        glm::vec4 viewPosition = View * Transforms[transform] * glm::vec4(center, 1.0f);
+        float depth = FarPlane > 0.0f ? -viewPosition.z / FarPlane : 0.0f;
+
+        RenderCommand command;
+        command.Key = MakeSortKey(pass, shader.ID, mesh.MaterialID, vertexArray, depth);
+        command.ShaderProgram = &shader;
+        command.DrawMesh = &mesh;
+        command.VertexArray = vertexArray;
+        command.Transform = transform;
+        command.Lod = Lods != nullptr ? Lods->Select(mesh, Transforms[transform]) : 0;
+        command.Bounds = static_cast<unsigned int>(
+            Culler.Add(mesh.BoundsMin, mesh.BoundsMax, Transforms[transform]));
+        Commands.push_back(command);
+    }
+
+    /// <summary>
+    /// Sorts and draws everything submitted since Begin.
+    /// </summary>
+    void Flush()
+    {
+        // test every submitted box in one pass, then drop what can't be seen
+        size_t visible = Culler.Cull(ViewFrustum);
+        frameStats.MeshesVisible += static_cast<unsigned int>(visible);
+        frameStats.MeshesCulled += static_cast<unsigned int>(Commands.size() - visible);
+        Commands.erase(std::remove_if(Commands.begin(),
+                                      Commands.end(),
+                                      [this](const RenderCommand &command) {
+                                          return !Culler.IsVisible(command.Bounds);
+                                      }),
+                       Commands.end());
+
+        std::sort(Commands.begin(),
+                  Commands.end(),
+                  [](const RenderCommand &a, const RenderCommand &b) { return a.Key < b.Key; });
+        // anything may have been bound since the last flush
+        std::fill(std::begin(BoundTextures), std::end(BoundTextures), ~0u);
+
+        Shader *currentShader = nullptr;
+        int modelLocation = -1;
+        unsigned int currentMaterial = ~0u;
+        unsigned int currentVertexArray = ~0u;
+        unsigned int currentTransform = ~0u;
+        for (const RenderCommand &command : Commands)
+        {
+            if (command.ShaderProgram != currentShader)
+            {
+                currentShader = command.ShaderProgram;
+                currentShader->Use();
+                modelLocation = currentShader->GetUniformLocation("model");
+                // the transform belongs to the program, set it again
+                currentMaterial = ~0u;
+                currentTransform = ~0u;
+            }
+            if (command.DrawMesh->MaterialID != currentMaterial)
+            {
+                currentMaterial = command.DrawMesh->MaterialID;
+                MaterialRegistry::Get().Bind(
+                    currentMaterial, *currentShader, BoundTextures, MAX_TEXTURE_UNITS);
+            }
+            if (command.VertexArray != currentVertexArray)
+            {
+                currentVertexArray = command.VertexArray;
+                glBindVertexArray(currentVertexArray);
+                ++frameStats.VertexArrayBinds;
+            }
+            if (command.Transform != currentTransform)
+            {
+                currentTransform = command.Transform;
+                glUniformMatrix4fv(modelLocation, 1, GL_FALSE, &Transforms[currentTransform][0][0]);
+            }
+            const Mesh &mesh = *command.DrawMesh;
+            if (CullMeshlets && command.Lod == 0 && !mesh.Meshlets.empty())
+            {
+                Clusters.Cull(mesh, Transforms[command.Transform]);
+                Clusters.Draw(mesh);
+            }
+            else
+            {
+                mesh.DrawRange(command.Lod);
+            }
+        }
+
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+        Commands.clear();
+    }
+
+    size_t GetCommandCount() const
+    {
+        return Commands.size();
+    }
+
+private:
+    struct RenderCommand
+    {
+        uint64_t Key;
+        Shader *ShaderProgram;
+        const Mesh *DrawMesh;
+        unsigned int VertexArray;
+        unsigned int Transform; // index into Transforms
+        unsigned int Lod;       // into DrawMesh->Lods
+        unsigned int Bounds;    // index into Culler
+    };
+
+    // texture units the queue keeps track of
+    static const unsigned int MAX_TEXTURE_UNITS = 16;
+
+    vector<RenderCommand> Commands;
+    vector<glm::mat4> Transforms;
+    glm::mat4 View = glm::mat4(1.0f);
+    float FarPlane = 0.0f;
+    Frustum ViewFrustum = {};
+    FrustumCuller Culler;
+    const LodSelector *Lods = nullptr;
+    MeshletCuller Clusters;
+    bool CullMeshlets = false;
+    unsigned int BoundTextures[MAX_TEXTURE_UNITS]; // texture on each unit during Flush
+};
+
+#endif
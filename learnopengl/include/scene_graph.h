@@ -0,0 +1,127 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/// <summary>
+/// A node hierarchy stored as flat arrays, one entry per node in depth first order: parents come
+/// before their children and every subtree is a contiguous range. World transforms are updated
+/// in one pass front to back, and only the nodes whose local transform changed since the last
+/// update, plus everything below them, are recomputed.
+/// </summary>
+struct SceneGraph
+{
+public:
+    vector<string> Names;
+    vector<int> Parents;               // -1 for roots
+    vector<unsigned int> SubtreeEnds;  // one past the last node of each node's subtree
+    vector<glm::mat4> LocalTransforms; // relative to the parent
+    vector<glm::mat4> WorldTransforms; // relative to the model, valid after Update
+    vector<uint8_t> Dirty;             // local transform changed since the last Update
+
+    /// <summary>
+    /// Appends a node, its parent has to be added already. Returns the node's index.
+    /// </summary>
+    unsigned int AddNode(const string &name, int parent, const glm::mat4 &localTransform)
+    {
+        unsigned int index = static_cast<unsigned int>(Parents.size());
+        Names.push_back(name);
+        Parents.push_back(parent);
+        SubtreeEnds.push_back(index + 1);
+        LocalTransforms.push_back(localTransform);
+        WorldTransforms.push_back(localTransform);
+        Dirty.push_back(1);
+        ++DirtyCount;
+
+        // the new node ends the subtree of every ancestor, depth first order keeps them contiguous
+        for (int ancestor = parent; ancestor >= 0; ancestor = Parents[ancestor])
+        {
+            SubtreeEnds[ancestor] = index + 1;
+        }
+        return index;
+    }
+
+    void SetLocalTransform(unsigned int node, const glm::mat4 &transform)
+    {
+        LocalTransforms[node] = transform;
+        if (!Dirty[node])
+        {
+            Dirty[node] = 1;
+            ++DirtyCount;
+        }
+    }
+
+    /// <summary>
+    /// Brings the world transforms up to date, returns how many were recomputed.
+    /// </summary>
+    unsigned int Update()
+    {
+        if (DirtyCount == 0)
+        {
+            return 0;
+        }
+
+        unsigned int updated = 0;
+        unsigned int count = static_cast<unsigned int>(Parents.size());
+        unsigned int node = 0;
+        while (node < count)
+        {
+            if (!Dirty[node])
+            {
+                ++node;
+                continue;
+            }
+
+            // the parent is either clean or was recomputed earlier in this pass, and everything
+            // below the node has to follow it
+            unsigned int end = SubtreeEnds[node];
+            for (unsigned int i = node; i < end; ++i)
+            {
+                glm::mat4 parentWorld = i == node ? ParentWorld(node) : WorldTransforms[Parents[i]];
+                WorldTransforms[i] = parentWorld * LocalTransforms[i];
+                Dirty[i] = 0;
+            }
+            updated += end - node;
+            node = end; // dirty descendants were just handled with the subtree
+        }
+        DirtyCount = 0;
+        return updated;
+    }
+
+    /// <summary>
+    /// Returns the index of the first node with the given name, or -1.
+    /// </summary>
+    int FindNode(const string &name) const
+    {
+        for (size_t i = 0; i < Names.size(); ++i)
+        {
+            if (Names[i] == name)
+            {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    size_t GetNodeCount() const
+    {
+        return Parents.size();
+    }
+
+private:
+    unsigned int DirtyCount = 0;
+
+    glm::mat4 ParentWorld(unsigned int node) const
+    {
+        return Parents[node] >= 0 ? WorldTransforms[Parents[node]] : glm::mat4(1.0f);
+    }
+};
+
+#endif
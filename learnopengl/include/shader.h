@@ -4,13 +4,57 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include <frame_stats.h>
+#include <gl_ext.h>
+#include <program_cache.h>
+#include <shader_preprocessor.h>
 
 using std::string;
 
+// Uniform blocks shared by every program that declares them. Each one is connected to its fixed
+// binding point when a program is linked, so its buffer is bound once and all programs read it.
+const unsigned int MATRICES_BINDING = 0;      // Matrices: projection and view, see FrameUniforms
+const unsigned int BONE_MATRICES_BINDING = 1; // BoneMatrices: see BoneMatrixBuffer
+
+struct StandardUniformBlock
+{
+    const char *Name;
+    unsigned int Binding;
+};
+
+const StandardUniformBlock STANDARD_UNIFORM_BLOCKS[] = {
+    {"Matrices", MATRICES_BINDING},
+    {"BoneMatrices", BONE_MATRICES_BINDING},
+};
+
+enum class ShaderBuild
+{
+    // compiled, linked and checked before the constructor returns
+    Immediate,
+    // compiles and links are only submitted, the status is checked on the first Use or Finish so
+    // the driver can work on the program in the meantime, see ShaderLibrary
+    Deferred,
+};
+
+/// <summary>
+/// Typed handle to a uniform of a Shader. Resolve it once with Shader::GetUniform and hold on to
+/// it, setting a value through a handle is a plain array index instead of a name lookup. A
+/// default constructed handle sets nothing.
+/// </summary>
+template <typename T>
+struct Uniform
+{
+    int Slot = -1;
+};
+
 struct Shader
 {
 public:
@@ -20,96 +64,305 @@ public:
     unsigned int ID;
 
     /// <summary>
-    /// Reads a vertex and fragment shader and builds it.
+    /// Reads a vertex and fragment shader and builds it. The sources may #include other files and
+    /// are compiled with defines, each "NAME" or "NAME VALUE", see ShaderPreprocessor.
     /// </summary>
-    Shader(const char *vertexPath, const char *fragmentPath, const char *geometryPath = nullptr)
+    Shader(const char *vertexPath,
+           const char *fragmentPath,
+           const char *geometryPath = nullptr,
+           ShaderBuild build = ShaderBuild::Immediate,
+           const std::vector<string> &defines = {})
     {
+        VertexPath = vertexPath;
+        FragmentPath = fragmentPath;
+        GeometryPath = geometryPath != nullptr ? geometryPath : "";
+        Defines = defines;
+
         // 1. retrive the vertex/fragment source code from the paths
         string vertexCode, fragmentCode, geometryCode;
-        std::ifstream vShaderFile, fShaderFile, gShaderFile;
-
-        // ensure ifstream objects can throw exceptions
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        gShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        ReadSources(vertexCode, fragmentCode, geometryCode);
 
-        try
+        // 2. restore the linked program from the binary cache, or submit its compile and link
+        auto begin = std::chrono::steady_clock::now();
+        ProgramBinaryCache &cache = ProgramBinaryCache::Get();
+        CacheKey = cache.MakeKey({vertexCode, fragmentCode, geometryCode},
+                                 ShaderPreprocessor::JoinDefines(Defines));
+        ID = glCreateProgram();
+        bool cached = cache.Load(CacheKey, ID);
+        if (!cached)
         {
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
+            cache.PrepareForSave(ID);
+            SubmitStages(ID, PendingStages, vertexCode, fragmentCode, geometryCode);
+        }
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - begin;
 
-            std::stringstream vShaderStream, fShaderStream;
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
+        if (cached)
+        {
+            ReflectUniforms();
+            BindStandardUniformBlocks();
+            ++shaderLoadStats.ProgramsLoaded;
+            shaderLoadStats.LoadMilliseconds += elapsed.count();
+        }
+        else
+        {
+            SubmitMilliseconds = elapsed.count();
+            if (build == ShaderBuild::Immediate)
+            {
+                Finish();
+            }
+        }
+    }
 
-            vShaderFile.close();
-            fShaderFile.close();
+    /// <summary>
+    /// Returns true once the program can be used without waiting for the driver. Without
+    /// GL_KHR_parallel_shader_compile a submitted program only becomes ready through Finish.
+    /// </summary>
+    bool IsReady() const
+    {
+        if (!IsPending())
+        {
+            return true;
+        }
+        if (!GLExtensions::Get().HasParallelShaderCompile)
+        {
+            return false;
+        }
+        int complete = 0;
+        glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+        return complete != 0;
+    }
 
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+    /// <summary>
+    /// Returns true while the compile and link of a deferred program haven't been checked yet.
+    /// </summary>
+    bool IsPending() const
+    {
+        return PendingStages[0] != 0;
+    }
 
-            if (geometryPath != nullptr)
-            {
-                gShaderFile.open(geometryPath);
-                std::stringstream gShaderStream;
-                gShaderStream << gShaderFile.rdbuf();
-                gShaderFile.close();
-                geometryCode = gShaderStream.str();
-            }
+    /// <summary>
+    /// Waits for a deferred program, reports its errors, fills the binary cache and reflects its
+    /// uniforms. Does nothing for a program that isn't pending. Use calls it by itself.
+    /// </summary>
+    void Finish()
+    {
+        if (!IsPending())
+        {
+            return;
         }
-        catch (std::ifstream::failure &e)
+        auto begin = std::chrono::steady_clock::now();
+        if (FinishStages(ID, PendingStages))
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+            ProgramBinaryCache::Get().Save(CacheKey, ID);
         }
-        const char *vShaderCode = vertexCode.c_str();
-        const char *fShaderCode = fragmentCode.c_str();
+        ReflectUniforms();
+        BindStandardUniformBlocks();
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - begin;
 
-        // 2. compile the shaders
-        unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-        CheckCompileErrors(vertex, "VERTEX");
+        // only the time spent on this thread, a deferred compile may take longer in the driver
+        ++shaderLoadStats.ProgramsCompiled;
+        shaderLoadStats.CompileMilliseconds += SubmitMilliseconds + elapsed.count();
+    }
 
-        unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-        CheckCompileErrors(fragment, "FRAGMENT");
+    /// <summary>
+    /// Reads the sources again and submits a new program built from them next to the current
+    /// one, which stays in use until FinishReload swaps them. A reload still running is dropped.
+    /// Returns false if the sources can't be read.
+    /// </summary>
+    bool StartReload()
+    {
+        Finish();
+        CancelReload();
 
-        unsigned int geometry;
-        if (geometryPath != nullptr)
+        string vertexCode, fragmentCode, geometryCode;
+        if (!ReadSources(vertexCode, fragmentCode, geometryCode))
         {
-            const char *gShaderCode = geometryCode.c_str();
-            geometry = glCreateShader(GL_GEOMETRY_SHADER);
-            glShaderSource(geometry, 1, &gShaderCode, NULL);
-            glCompileShader(geometry);
-            CheckCompileErrors(geometry, "GEOMETRY");
+            return false;
         }
+        ProgramBinaryCache &cache = ProgramBinaryCache::Get();
+        ReloadKey = cache.MakeKey({vertexCode, fragmentCode, geometryCode},
+                                  ShaderPreprocessor::JoinDefines(Defines));
+        ReloadID = glCreateProgram();
+        cache.PrepareForSave(ReloadID);
+        SubmitStages(ReloadID, ReloadStages, vertexCode, fragmentCode, geometryCode);
+        return true;
+    }
 
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        if (geometryPath != nullptr)
+    bool IsReloading() const
+    {
+        return ReloadID != 0;
+    }
+
+    /// <summary>
+    /// Swaps in the program of the last StartReload once it linked, keeping the uniform handles,
+    /// and the values of every uniform both programs have. A program that failed to build is
+    /// reported and dropped, the current one stays. Unless wait is set it returns false without
+    /// blocking while the driver is still busy. Without parallel shader compile there is no way
+    /// to ask without blocking, so only a call with wait set swaps. Returns true if the program
+    /// was swapped.
+    /// </summary>
+    bool FinishReload(bool wait = false)
+    {
+        if (!IsReloading())
+        {
+            return false;
+        }
+        if (!wait)
+        {
+            // any other status query waits for the whole compile and link
+            if (!GLExtensions::Get().HasParallelShaderCompile)
+            {
+                return false;
+            }
+            int complete = 0;
+            glGetProgramiv(ReloadID, GL_COMPLETION_STATUS_KHR, &complete);
+            if (complete == 0)
+            {
+                return false;
+            }
+        }
+
+        unsigned int program = ReloadID;
+        ReloadID = 0;
+        if (!FinishStages(program, ReloadStages))
         {
-            glAttachShader(ID, geometry);
+            std::cout << "ERROR::SHADER::RELOAD_FAILED: " << VertexPath << std::endl;
+            glDeleteProgram(program);
+            ++shaderLoadStats.ReloadsFailed;
+            return false;
         }
-        glLinkProgram(ID);
-        CheckCompileErrors(ID, "PROGRAM");
+        ProgramBinaryCache::Get().Save(ReloadKey, program);
+        CopyUniformValues(ID, program);
 
-        // 3. delete the shaders as they're properly linked into the program and are not needed
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-        if (geometryPath != nullptr)
+        glDeleteProgram(ID);
+        ID = program;
+        CacheKey = ReloadKey;
+        // the handles keep their slots, only the locations behind them are looked up again
+        std::fill(UniformLocations.begin(), UniformLocations.end(), -1);
+        ReflectUniforms();
+        BindStandardUniformBlocks();
+        std::fill(SamplerUnits.begin(), SamplerUnits.end(), -1);
+        ++shaderLoadStats.ProgramsReloaded;
+        return true;
+    }
+
+    /// <summary>
+    /// Drops a reload that hasn't been swapped in yet.
+    /// </summary>
+    void CancelReload()
+    {
+        if (IsReloading())
         {
-            glDeleteShader(geometry);
+            FinishStages(ReloadID, ReloadStages);
+            glDeleteProgram(ReloadID);
+            ReloadID = 0;
         }
     }
 
+    /// <summary>
+    /// The source files of the program, the geometry path is empty without a geometry stage.
+    /// </summary>
+    const string &GetVertexPath() const
+    {
+        return VertexPath;
+    }
+
+    const string &GetFragmentPath() const
+    {
+        return FragmentPath;
+    }
+
+    const string &GetGeometryPath() const
+    {
+        return GeometryPath;
+    }
+
+    /// <summary>
+    /// Every file the sources were read from, included ones too, as of the last build.
+    /// </summary>
+    const std::vector<string> &GetSourceFiles() const
+    {
+        return SourceFiles;
+    }
+
+    const std::vector<string> &GetDefines() const
+    {
+        return Defines;
+    }
+
     /// <summary>
     /// Uses, or activates, the shader.
     /// </summary>
     void Use()
     {
+        Finish();
         glUseProgram(ID);
+        ++frameStats.ProgramBinds;
+    }
+
+    /// <summary>
+    /// Returns the location of a uniform from the table built at link time, or -1 if the program
+    /// has no active uniform with that name (which glUniform* silently ignores, like the driver).
+    /// A deferred program has no table before its first Use.
+    /// </summary>
+    int GetUniformLocation(const string &name) const
+    {
+        ++frameStats.UniformTableLookups;
+        auto it = UniformSlots.find(name);
+        return it != UniformSlots.end() ? UniformLocations[it->second] : -1;
+    }
+
+    /// <summary>
+    /// Returns a typed handle for a uniform. Unknown names still get a handle, setting it does
+    /// nothing.
+    /// </summary>
+    template <typename T>
+    Uniform<T> GetUniform(const string &name)
+    {
+        Uniform<T> uniform;
+        uniform.Slot = AddUniformSlot(name, -1);
+        return uniform;
+    }
+
+    /// <summary>
+    /// Points a sampler at a texture unit, for the material binding tables. Samplers are numbered
+    /// process wide (see MaterialRegistry), the name is only read the first time this program sees
+    /// a sampler. The unit is only sent when it differs from what this program last got from here,
+    /// so the program has to be in use and its samplers shouldn't be set by name as well.
+    /// </summary>
+    void SetSampler(unsigned int sampler, const string &name, int unit)
+    {
+        if (sampler >= SamplerSlots.size())
+        {
+            SamplerSlots.resize(sampler + 1, -1);
+            SamplerUnits.resize(sampler + 1, -1);
+        }
+        if (SamplerSlots[sampler] < 0)
+        {
+            SamplerSlots[sampler] = AddUniformSlot(name, -1);
+        }
+        if (SamplerUnits[sampler] != unit)
+        {
+            SamplerUnits[sampler] = unit;
+            glUniform1i(UniformLocations[SamplerSlots[sampler]], unit);
+        }
+    }
+
+    /// <summary>
+    /// Connects a uniform block to a buffer binding point. Returns false if the program has no
+    /// active block with that name.
+    /// </summary>
+    bool SetUniformBlockBinding(const string &block, unsigned int binding) const
+    {
+        unsigned int index = glGetUniformBlockIndex(ID, block.c_str());
+        if (index == GL_INVALID_INDEX)
+        {
+            return false;
+        }
+        glUniformBlockBinding(ID, index, binding);
+        return true;
     }
 
     /// <summary>
@@ -117,7 +370,7 @@ public:
     /// </summary>
     void SetBool(const string &name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(GetUniformLocation(name), (int)value);
     }
 
     /// <summary>
@@ -125,7 +378,7 @@ public:
     /// </summary>
     void SetInt(const string &name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(GetUniformLocation(name), value);
     }
 
     /// <summary>
@@ -133,7 +386,7 @@ public:
     /// </summary>
     void SetFloat(const string &name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(GetUniformLocation(name), value);
     }
 
     /// <summary>
@@ -141,7 +394,7 @@ public:
     /// </summary>
     void SetVec2(const string& name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(GetUniformLocation(name), x, y);
     }
 
     /// <summary>
@@ -149,7 +402,7 @@ public:
     /// </summary>
     void SetVec2(const string &name, glm::vec2 &value) const 
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform2fv(GetUniformLocation(name), 1, &value[0]);
     }
 
     /// <summary>
@@ -157,7 +410,7 @@ public:
     /// </summary>
     void SetVec3(const string &name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(GetUniformLocation(name), x, y, z);
     }
 
     /// <summary>
@@ -165,7 +418,7 @@ public:
     /// </summary>
     void SetVec3(const string &name, glm::vec3 &value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(GetUniformLocation(name), 1, &value[0]);
     }
 
     // <summary>
@@ -173,7 +426,7 @@ public:
     /// </summary>
     void SetVec4(const string &name, float x, float y, float z, float w) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(GetUniformLocation(name), x, y, z, w);
     }
 
     /// <summary>
@@ -181,7 +434,7 @@ public:
     /// </summary>
     void SetVec4(const string &name, glm::vec4 &value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(GetUniformLocation(name), 1, &value[0]);
     }
 
     /// <summary>
@@ -189,7 +442,7 @@ public:
     /// </summary>
     void SetMat2x2(const string &name, glm::mat2 &value) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+        glUniformMatrix2fv(GetUniformLocation(name), 1, GL_FALSE, &value[0][0]);
     }
 
     /// <summary>
@@ -197,7 +450,7 @@ public:
     /// </summary>
     void SetMat3x3(const string &name, glm::mat3 &value) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+        glUniformMatrix3fv(GetUniformLocation(name), 1, GL_FALSE, &value[0][0]);
     }
 
     /// <summary>
@@ -205,11 +458,479 @@ public:
     /// </summary>
     void SetMat4x4(const string &name, glm::mat4 &value) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &value[0][0]);
+        glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &value[0][0]);
+    }
+
+    /// <summary>
+    /// Sets a boolean uniform value through a handle.
+    /// </summary>
+    void SetBool(Uniform<bool> uniform, bool value) const
+    {
+        glUniform1i(GetSlotLocation(uniform.Slot), (int)value);
+    }
+
+    /// <summary>
+    /// Sets an integer uniform value through a handle.
+    /// </summary>
+    void SetInt(Uniform<int> uniform, int value) const
+    {
+        glUniform1i(GetSlotLocation(uniform.Slot), value);
+    }
+
+    /// <summary>
+    /// Sets a float uniform value through a handle.
+    /// </summary>
+    void SetFloat(Uniform<float> uniform, float value) const
+    {
+        glUniform1f(GetSlotLocation(uniform.Slot), value);
+    }
+
+    /// <summary>
+    /// Sets a Vector2 uniform value through a handle.
+    /// </summary>
+    void SetVec2(Uniform<glm::vec2> uniform, const glm::vec2 &value) const
+    {
+        glUniform2fv(GetSlotLocation(uniform.Slot), 1, &value[0]);
+    }
+
+    /// <summary>
+    /// Sets a Vector3 uniform value through a handle.
+    /// </summary>
+    void SetVec3(Uniform<glm::vec3> uniform, const glm::vec3 &value) const
+    {
+        glUniform3fv(GetSlotLocation(uniform.Slot), 1, &value[0]);
+    }
+
+    /// <summary>
+    /// Sets a Vector4 uniform value through a handle.
+    /// </summary>
+    void SetVec4(Uniform<glm::vec4> uniform, const glm::vec4 &value) const
+    {
+        glUniform4fv(GetSlotLocation(uniform.Slot), 1, &value[0]);
+    }
+
+    /// <summary>
+    /// Sets a Matrix3x3 uniform value through a handle.
+    /// </summary>
+    void SetMat3x3(Uniform<glm::mat3> uniform, const glm::mat3 &value) const
+    {
+        glUniformMatrix3fv(GetSlotLocation(uniform.Slot), 1, GL_FALSE, &value[0][0]);
+    }
+
+    /// <summary>
+    /// Sets a Matrix4x4 uniform value through a handle.
+    /// </summary>
+    void SetMat4x4(Uniform<glm::mat4> uniform, const glm::mat4 &value) const
+    {
+        glUniformMatrix4fv(GetSlotLocation(uniform.Slot), 1, GL_FALSE, &value[0][0]);
     }
 
 private:
-    void CheckCompileErrors(unsigned int shader, string type)
+    // uniform name -> slot in UniformLocations, filled once after linking
+    std::unordered_map<string, int> UniformSlots;
+    // slot -> location in the linked program, handles index straight into this
+    std::vector<int> UniformLocations;
+    // process wide sampler number -> uniform slot and the texture unit it was last set to
+    std::vector<int> SamplerSlots;
+    std::vector<int> SamplerUnits;
+    // vertex, fragment and geometry stage of a program whose status hasn't been checked yet
+    unsigned int PendingStages[3] = {};
+    uint64_t CacheKey = 0;
+    double SubmitMilliseconds = 0.0;
+    // sources, read again on reload
+    string VertexPath;
+    string FragmentPath;
+    string GeometryPath;
+    std::vector<string> Defines;
+    std::vector<string> SourceFiles; // normalized, see ShaderPreprocessor
+    // program being rebuilt next to ID by StartReload, 0 if none
+    unsigned int ReloadID = 0;
+    unsigned int ReloadStages[3] = {};
+    uint64_t ReloadKey = 0;
+
+    /// <summary>
+    /// Reads the source of every stage through the preprocessor and records the files read.
+    /// Returns false if a file is missing or an include is broken.
+    /// </summary>
+    bool ReadSources(string &vertexCode, string &fragmentCode, string &geometryCode)
+    {
+        SourceFiles.clear();
+        const string *paths[3] = {&VertexPath, &FragmentPath, &GeometryPath};
+        string *codes[3] = {&vertexCode, &fragmentCode, &geometryCode};
+        bool read = true;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (!paths[i]->empty())
+            {
+                read = ShaderPreprocessor::Process(*paths[i], Defines, *codes[i], SourceFiles) &&
+                       read;
+            }
+        }
+        return read;
+    }
+
+    /// <summary>
+    /// Copies the values of the active uniforms of to that from also has, so a rebuilt program
+    /// starts out with what was set on the old one. Uses to, the program bound before isn't
+    /// restored.
+    /// </summary>
+    static void CopyUniformValues(unsigned int from, unsigned int to)
+    {
+        int count = 0;
+        int maxNameLength = 0;
+        glGetProgramiv(to, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(to, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+        glUseProgram(to);
+        ++frameStats.ProgramBinds;
+
+        std::vector<char> nameBuffer(maxNameLength + 1);
+        for (int i = 0; i < count; ++i)
+        {
+            int length = 0;
+            int size = 0;
+            GLenum type;
+            glGetActiveUniform(to, i, maxNameLength + 1, &length, &size, &type, nameBuffer.data());
+            string name(nameBuffer.data(), length);
+            // arrays are reported as "name[0]", their elements are copied one by one
+            bool array = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+            string baseName = array ? name.substr(0, name.size() - 3) : name;
+
+            for (int element = 0; element < size; ++element)
+            {
+                string elementName =
+                    array ? baseName + '[' + std::to_string(element) + ']' : baseName;
+                int source = glGetUniformLocation(from, elementName.c_str());
+                int target = glGetUniformLocation(to, elementName.c_str());
+                if (source >= 0 && target >= 0)
+                {
+                    CopyUniformValue(from, source, target, type);
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Copies one uniform value of type from a location of program from to the bound program.
+    /// Types GLSL 3.30 doesn't have, e.g. doubles, are skipped.
+    /// </summary>
+    static void CopyUniformValue(unsigned int from, int source, int target, GLenum type)
+    {
+        float floats[16];
+        int ints[4];
+        unsigned int uints[4];
+        switch (type)
+        {
+        case GL_FLOAT:
+            glGetUniformfv(from, source, floats);
+            glUniform1fv(target, 1, floats);
+            break;
+        case GL_FLOAT_VEC2:
+            glGetUniformfv(from, source, floats);
+            glUniform2fv(target, 1, floats);
+            break;
+        case GL_FLOAT_VEC3:
+            glGetUniformfv(from, source, floats);
+            glUniform3fv(target, 1, floats);
+            break;
+        case GL_FLOAT_VEC4:
+            glGetUniformfv(from, source, floats);
+            glUniform4fv(target, 1, floats);
+            break;
+        case GL_FLOAT_MAT2:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix2fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT3:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix3fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT4:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix4fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT2x3:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix2x3fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT3x2:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix3x2fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT2x4:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix2x4fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT4x2:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix4x2fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT3x4:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix3x4fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_FLOAT_MAT4x3:
+            glGetUniformfv(from, source, floats);
+            glUniformMatrix4x3fv(target, 1, GL_FALSE, floats);
+            break;
+        case GL_INT_VEC2:
+        case GL_BOOL_VEC2:
+            glGetUniformiv(from, source, ints);
+            glUniform2iv(target, 1, ints);
+            break;
+        case GL_INT_VEC3:
+        case GL_BOOL_VEC3:
+            glGetUniformiv(from, source, ints);
+            glUniform3iv(target, 1, ints);
+            break;
+        case GL_INT_VEC4:
+        case GL_BOOL_VEC4:
+            glGetUniformiv(from, source, ints);
+            glUniform4iv(target, 1, ints);
+            break;
+        case GL_UNSIGNED_INT:
+            glGetUniformuiv(from, source, uints);
+            glUniform1uiv(target, 1, uints);
+            break;
+        case GL_UNSIGNED_INT_VEC2:
+            glGetUniformuiv(from, source, uints);
+            glUniform2uiv(target, 1, uints);
+            break;
+        case GL_UNSIGNED_INT_VEC3:
+            glGetUniformuiv(from, source, uints);
+            glUniform3uiv(target, 1, uints);
+            break;
+        case GL_UNSIGNED_INT_VEC4:
+            glGetUniformuiv(from, source, uints);
+            glUniform4uiv(target, 1, uints);
+            break;
+        default:
+            if (IsSingleIntUniform(type))
+            {
+                glGetUniformiv(from, source, ints);
+                glUniform1iv(target, 1, ints);
+            }
+            break;
+        }
+    }
+
+    /// <summary>
+    /// Returns true for int, bool and the sampler types of GLSL 3.30, all set as one int.
+    /// </summary>
+    static bool IsSingleIntUniform(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_INT:
+        case GL_BOOL:
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_1D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_1D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_RECT:
+        case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_1D:
+        case GL_INT_SAMPLER_2D:
+        case GL_INT_SAMPLER_3D:
+        case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY:
+        case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_INT_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_1D:
+        case GL_UNSIGNED_INT_SAMPLER_2D:
+        case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// <summary>
+    /// Submits the compiles of the stages and the link of program without asking for any status,
+    /// which would wait for each stage before the next is handed to the driver. An empty
+    /// geometryCode means no geometry stage.
+    /// </summary>
+    static void SubmitStages(unsigned int program,
+                             unsigned int (&stages)[3],
+                             const string &vertexCode,
+                             const string &fragmentCode,
+                             const string &geometryCode)
+    {
+        const char *vShaderCode = vertexCode.c_str();
+        const char *fShaderCode = fragmentCode.c_str();
+
+        stages[0] = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(stages[0], 1, &vShaderCode, NULL);
+        glCompileShader(stages[0]);
+
+        stages[1] = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(stages[1], 1, &fShaderCode, NULL);
+        glCompileShader(stages[1]);
+
+        if (!geometryCode.empty())
+        {
+            const char *gShaderCode = geometryCode.c_str();
+            stages[2] = glCreateShader(GL_GEOMETRY_SHADER);
+            glShaderSource(stages[2], 1, &gShaderCode, NULL);
+            glCompileShader(stages[2]);
+        }
+
+        for (unsigned int stage : stages)
+        {
+            if (stage != 0)
+            {
+                glAttachShader(program, stage);
+            }
+        }
+        glLinkProgram(program);
+    }
+
+    /// <summary>
+    /// Checks the stages and the link submitted by SubmitStages and deletes the stages. Returns
+    /// true if the program linked.
+    /// </summary>
+    static bool FinishStages(unsigned int program, unsigned int (&stages)[3])
+    {
+        const char *types[3] = {"VERTEX", "FRAGMENT", "GEOMETRY"};
+        for (int i = 0; i < 3; ++i)
+        {
+            if (stages[i] != 0)
+            {
+                CheckCompileErrors(stages[i], types[i]);
+            }
+        }
+        CheckCompileErrors(program, "PROGRAM");
+
+        // delete the shaders as they're properly linked into the program and are not needed
+        for (unsigned int &stage : stages)
+        {
+            if (stage != 0)
+            {
+                glDetachShader(program, stage);
+                glDeleteShader(stage);
+                stage = 0;
+            }
+        }
+
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        return success != 0;
+    }
+
+    /// <summary>
+    /// Returns the location behind a handle's slot, or -1 (ignored by glUniform*) for an unresolved
+    /// handle or one whose slot is outside this program's table.
+    /// </summary>
+    int GetSlotLocation(int slot) const
+    {
+        if (slot < 0 || static_cast<size_t>(slot) >= UniformLocations.size())
+        {
+            return -1;
+        }
+        return UniformLocations[slot];
+    }
+
+    /// <summary>
+    /// Walks the active uniforms of the linked program once and records their locations, so no
+    /// setter has to ask the driver again. Array uniforms are registered under their base name and
+    /// under every element name.
+    /// </summary>
+    void ReflectUniforms()
+    {
+        int count = 0;
+        int maxNameLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+        std::vector<char> nameBuffer(maxNameLength + 1);
+        for (int i = 0; i < count; ++i)
+        {
+            int length = 0;
+            int size = 0;
+            GLenum type;
+            glGetActiveUniform(ID, i, maxNameLength + 1, &length, &size, &type, nameBuffer.data());
+            string name(nameBuffer.data(), length);
+
+            int location = QueryUniformLocation(name);
+            if (location < 0)
+            {
+                continue; // lives in a uniform block, those have no location
+            }
+            AddUniformSlot(name, location);
+
+            // arrays are reported as "name[0]"
+            if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            {
+                string baseName = name.substr(0, name.size() - 3);
+                AddUniformSlot(baseName, location);
+                for (int element = 1; element < size; ++element)
+                {
+                    string elementName = baseName + '[' + std::to_string(element) + ']';
+                    AddUniformSlot(elementName, QueryUniformLocation(elementName));
+                }
+            }
+        }
+    }
+
+    /// <summary>
+    /// Connects the blocks of STANDARD_UNIFORM_BLOCKS the program declares to their binding
+    /// points.
+    /// </summary>
+    void BindStandardUniformBlocks() const
+    {
+        for (const StandardUniformBlock &block : STANDARD_UNIFORM_BLOCKS)
+        {
+            SetUniformBlockBinding(block.Name, block.Binding);
+        }
+    }
+
+    int QueryUniformLocation(const string &name) const
+    {
+        ++frameStats.UniformLocationQueries;
+        return glGetUniformLocation(ID, name.c_str());
+    }
+
+    /// <summary>
+    /// Returns the slot for a name, creating it with the given location if it doesn't exist yet.
+    /// </summary>
+    int AddUniformSlot(const string &name, int location)
+    {
+        auto it = UniformSlots.find(name);
+        if (it != UniformSlots.end())
+        {
+            if (location >= 0)
+            {
+                UniformLocations[it->second] = location;
+            }
+            return it->second;
+        }
+
+        int slot = static_cast<int>(UniformLocations.size());
+        UniformLocations.push_back(location);
+        UniformSlots.emplace(name, slot);
+        return slot;
+    }
+
+    static void CheckCompileErrors(unsigned int shader, string type)
     {
         int success;
         char infoLog[1024];
@@ -0,0 +1,305 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <file_watcher.h>
+#include <gl_ext.h>
+#include <shader.h>
+
+using std::string;
+using std::vector;
+
+/// <summary>
+/// The sources of a family of programs that differ only in which keywords are defined, see
+/// ShaderLibrary::AddPermutations.
+/// </summary>
+struct ShaderPermutations
+{
+    string VertexPath;
+    string FragmentPath;
+    string GeometryPath; // empty without a geometry stage
+    vector<string> Keywords;
+};
+
+/// <summary>
+/// Owns the programs of a scene by name. Add only submits a program's compiles and link, so every
+/// program can be handed to the driver at startup and built while models and textures load; a
+/// program is waited for the first time it is used, or by Poll and FinishAll.
+///
+/// Permutations of one set of sources are built the first time a combination of keywords is asked
+/// for and kept under that combination, so only the variants the scene actually draws with are
+/// compiled.
+///
+/// With hot reload on, Update rebuilds the programs whose sources were saved next to the ones in
+/// use. With parallel shader compile it swaps each in once the driver is done with it, so editing
+/// a shader doesn't stall frames. Plain GL 3.3 can't tell when a build is done without waiting
+/// for it, so there the rebuilds are only swapped in by FinishReloads, at a time the caller picks.
+/// </summary>
+struct ShaderLibrary
+{
+public:
+    ShaderLibrary() = default;
+
+    ~ShaderLibrary()
+    {
+        for (std::unique_ptr<Shader> &shader : Programs)
+        {
+            shader->Finish(); // deletes the stages of a program still pending
+            shader->CancelReload();
+            glDeleteProgram(shader->ID);
+        }
+    }
+
+    // the programs are handed out by reference
+    ShaderLibrary(const ShaderLibrary &) = delete;
+    ShaderLibrary &operator=(const ShaderLibrary &) = delete;
+
+    /// <summary>
+    /// Submits a program built with defines and returns it. The reference stays valid for the
+    /// library's lifetime, a name that was already added returns the existing program.
+    /// </summary>
+    Shader &Add(const string &name,
+                const char *vertexPath,
+                const char *fragmentPath,
+                const char *geometryPath = nullptr,
+                const vector<string> &defines = {})
+    {
+        auto it = Names.find(name);
+        if (it != Names.end())
+        {
+            return *Programs[it->second];
+        }
+        Names.emplace(name, Programs.size());
+        Programs.push_back(std::make_unique<Shader>(
+            vertexPath, fragmentPath, geometryPath, ShaderBuild::Deferred, defines));
+        if (Watcher != nullptr)
+        {
+            WatchSources(*Programs.back());
+        }
+        return *Programs.back();
+    }
+
+    /// <summary>
+    /// Returns the program added under name, finished, or nullptr if there is none.
+    /// </summary>
+    Shader *Get(const string &name)
+    {
+        auto it = Names.find(name);
+        if (it == Names.end())
+        {
+            std::cout << "ERROR::SHADER_LIBRARY::UNKNOWN_PROGRAM: " << name << std::endl;
+            return nullptr;
+        }
+        Shader *shader = Programs[it->second].get();
+        shader->Finish();
+        return shader;
+    }
+
+    /// <summary>
+    /// Registers sources whose programs are built per combination of keywords by GetPermutation.
+    /// Nothing is compiled yet.
+    /// </summary>
+    void AddPermutations(const string &name,
+                         const char *vertexPath,
+                         const char *fragmentPath,
+                         const char *geometryPath,
+                         const vector<string> &keywords)
+    {
+        ShaderPermutations permutations;
+        permutations.VertexPath = vertexPath;
+        permutations.FragmentPath = fragmentPath;
+        permutations.GeometryPath = geometryPath != nullptr ? geometryPath : "";
+        permutations.Keywords = keywords;
+        Permutations[name] = permutations;
+    }
+
+    /// <summary>
+    /// Returns the program of the permutations added under name with the given keywords defined,
+    /// submitting it on the first request. A keyword may carry a value, "NUM_POINT_LIGHTS 2". The
+    /// order of the keywords doesn't matter, ones not registered for name are reported and left
+    /// out. Returns nullptr if name is unknown.
+    /// </summary>
+    Shader *GetPermutation(const string &name, vector<string> keywords)
+    {
+        auto it = Permutations.find(name);
+        if (it == Permutations.end())
+        {
+            std::cout << "ERROR::SHADER_LIBRARY::UNKNOWN_PERMUTATIONS: " << name << std::endl;
+            return nullptr;
+        }
+        const ShaderPermutations &permutations = it->second;
+
+        auto unknown = [&](const string &keyword) {
+            string keywordName = keyword.substr(0, keyword.find(' '));
+            bool known = std::find(permutations.Keywords.begin(),
+                                   permutations.Keywords.end(),
+                                   keywordName) != permutations.Keywords.end();
+            if (!known)
+            {
+                std::cout << "ERROR::SHADER_LIBRARY::UNKNOWN_KEYWORD: " << keyword << " for "
+                          << name << std::endl;
+            }
+            return !known;
+        };
+        keywords.erase(std::remove_if(keywords.begin(), keywords.end(), unknown), keywords.end());
+        std::sort(keywords.begin(), keywords.end());
+        keywords.erase(std::unique(keywords.begin(), keywords.end()), keywords.end());
+
+        string key = name;
+        for (const string &keyword : keywords)
+        {
+            key += '#' + keyword;
+        }
+        const char *geometryPath =
+            permutations.GeometryPath.empty() ? nullptr : permutations.GeometryPath.c_str();
+        return &Add(key,
+                    permutations.VertexPath.c_str(),
+                    permutations.FragmentPath.c_str(),
+                    geometryPath,
+                    keywords);
+    }
+
+    /// <summary>
+    /// Finishes the programs the driver is done with without waiting for the others, and returns
+    /// how many are still pending. Only finds finished programs with parallel shader compile.
+    /// </summary>
+    size_t Poll()
+    {
+        size_t pending = 0;
+        for (std::unique_ptr<Shader> &shader : Programs)
+        {
+            if (!shader->IsPending())
+            {
+                continue;
+            }
+            if (shader->IsReady())
+            {
+                shader->Finish();
+            }
+            else
+            {
+                ++pending;
+            }
+        }
+        return pending;
+    }
+
+    /// <summary>
+    /// Waits for every pending program, e.g. before the first frame so none stalls it.
+    /// </summary>
+    void FinishAll()
+    {
+        for (std::unique_ptr<Shader> &shader : Programs)
+        {
+            shader->Finish();
+        }
+    }
+
+    /// <summary>
+    /// Starts watching the sources of every program, added before or after.
+    /// </summary>
+    void EnableHotReload()
+    {
+        if (Watcher != nullptr)
+        {
+            return;
+        }
+        Watcher = std::make_unique<FileWatcher>();
+        for (std::unique_ptr<Shader> &shader : Programs)
+        {
+            WatchSources(*shader);
+        }
+    }
+
+    /// <summary>
+    /// Call once per frame before drawing. Starts rebuilding the programs whose sources changed
+    /// and swaps in the rebuilds the driver finished, returns how many were swapped. Never swaps
+    /// without parallel shader compile, see FinishReloads.
+    /// </summary>
+    size_t Update()
+    {
+        if (Watcher == nullptr)
+        {
+            return 0;
+        }
+        for (const string &file : Watcher->Poll())
+        {
+            for (std::unique_ptr<Shader> &shader : Programs)
+            {
+                if (UsesFile(*shader, file) && shader->StartReload())
+                {
+                    std::cout << "SHADER_LIBRARY:: Reloading " << file;
+                    if (!GLExtensions::Get().HasParallelShaderCompile)
+                    {
+                        std::cout << ", swapped in by FinishReloads";
+                    }
+                    std::cout << std::endl;
+                    WatchSources(*shader); // the edit may have added includes
+                }
+            }
+        }
+
+        size_t swapped = 0;
+        for (std::unique_ptr<Shader> &shader : Programs)
+        {
+            if (shader->FinishReload())
+            {
+                ++swapped;
+            }
+        }
+        return swapped;
+    }
+
+    /// <summary>
+    /// Waits for every reload started by Update and swaps in the ones that built, returns how
+    /// many were swapped. Stalls for as long as the driver needs to build them.
+    /// </summary>
+    size_t FinishReloads()
+    {
+        size_t swapped = 0;
+        for (std::unique_ptr<Shader> &shader : Programs)
+        {
+            if (shader->FinishReload(true))
+            {
+                ++swapped;
+            }
+        }
+        return swapped;
+    }
+
+    size_t GetCount() const
+    {
+        return Programs.size();
+    }
+
+private:
+    // unique_ptr keeps every Shader where it is while more are added
+    vector<std::unique_ptr<Shader>> Programs;
+    std::unordered_map<string, size_t> Names;
+    std::unordered_map<string, ShaderPermutations> Permutations;
+    std::unique_ptr<FileWatcher> Watcher; // null until EnableHotReload
+
+    static bool UsesFile(const Shader &shader, const string &file)
+    {
+        const vector<string> &files = shader.GetSourceFiles();
+        return std::find(files.begin(), files.end(), file) != files.end();
+    }
+
+    void WatchSources(const Shader &shader)
+    {
+        for (const string &file : shader.GetSourceFiles())
+        {
+            Watcher->Watch(file);
+        }
+    }
+};
+
+#endif
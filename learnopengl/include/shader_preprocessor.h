@@ -0,0 +1,184 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+// includes nested deeper than this are taken for a cycle
+const int SHADER_INCLUDE_MAX_DEPTH = 16;
+
+/// <summary>
+/// Expands the #include "file" lines of GLSL sources and injects defines, neither of which GLSL
+/// does by itself. Included paths are relative to the including file and every file is included
+/// once per stage, so shared headers need no guards. #line directives keep compile errors pointing
+/// at the right line; the source string number in them is the file's index in the stage's files.
+/// Only the stage itself has a #version line, included files are plain GLSL.
+/// </summary>
+struct ShaderPreprocessor
+{
+public:
+    /// <summary>
+    /// Reads the stage at path with its includes into code and adds every file it read to files,
+    /// if not in there yet. Each define is "NAME" or "NAME VALUE" and goes right after #version.
+    /// Returns false if a file can't be read or an include is malformed.
+    /// </summary>
+    static bool Process(const string &path,
+                        const vector<string> &defines,
+                        string &code,
+                        vector<string> &files)
+    {
+        vector<string> stageFiles;
+        std::ostringstream expanded;
+        bool read = Expand(Normalize(path), 0, expanded, stageFiles);
+        for (const string &file : stageFiles)
+        {
+            if (std::find(files.begin(), files.end(), file) == files.end())
+            {
+                files.push_back(file);
+            }
+        }
+        if (!read)
+        {
+            return false;
+        }
+        code = InjectDefines(expanded.str(), defines);
+        return true;
+    }
+
+    /// <summary>
+    /// Joins defines into one string, for keys that have to tell permutations apart.
+    /// </summary>
+    static string JoinDefines(const vector<string> &defines)
+    {
+        string joined;
+        for (const string &define : defines)
+        {
+            joined += define;
+            joined += '\n';
+        }
+        return joined;
+    }
+
+    static string Normalize(const string &path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+private:
+    static bool Expand(const string &path,
+                       int depth,
+                       std::ostringstream &out,
+                       vector<string> &files)
+    {
+        // recorded even when missing, so a watcher picks it up once it exists
+        files.push_back(path);
+        size_t index = files.size() - 1;
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return false;
+        }
+
+        string line;
+        int lineNumber = 0;
+        while (std::getline(file, line))
+        {
+            ++lineNumber;
+            string includePath;
+            if (!ParseInclude(line, includePath))
+            {
+                out << line << '\n';
+                continue;
+            }
+            if (includePath.empty())
+            {
+                std::cout << "ERROR::SHADER::MALFORMED_INCLUDE: " << path << "(" << lineNumber
+                          << "): " << line << std::endl;
+                return false;
+            }
+
+            string included =
+                Normalize((std::filesystem::path(path).parent_path() / includePath).string());
+            if (std::find(files.begin(), files.end(), included) != files.end())
+            {
+                out << '\n'; // included before, keep the line count
+                continue;
+            }
+            if (depth + 1 >= SHADER_INCLUDE_MAX_DEPTH)
+            {
+                std::cout << "ERROR::SHADER::INCLUDE_TOO_DEEP: " << included << std::endl;
+                return false;
+            }
+            out << "#line 1 " << files.size() << '\n';
+            if (!Expand(included, depth + 1, out, files))
+            {
+                return false;
+            }
+            out << "#line " << lineNumber + 1 << ' ' << index << '\n';
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Returns true if line is an #include directive and puts the quoted path in path, left empty
+    /// when the quotes are missing.
+    /// </summary>
+    static bool ParseInclude(const string &line, string &path)
+    {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == string::npos || line.compare(start, 8, "#include") != 0)
+        {
+            return false;
+        }
+        size_t open = line.find('"', start + 8);
+        size_t close = open == string::npos ? string::npos : line.find('"', open + 1);
+        if (close != string::npos)
+        {
+            path = line.substr(open + 1, close - open - 1);
+        }
+        return true;
+    }
+
+    static string InjectDefines(const string &code, const vector<string> &defines)
+    {
+        if (defines.empty())
+        {
+            return code;
+        }
+        string block;
+        for (const string &define : defines)
+        {
+            block += "#define " + define + '\n';
+        }
+
+        // #version has to stay the first directive
+        size_t version = code.find("#version");
+        if (version == string::npos)
+        {
+            return block + "#line 1 0\n" + code;
+        }
+        size_t lineEnd = code.find('\n', version);
+        if (lineEnd == string::npos)
+        {
+            return code + '\n' + block;
+        }
+        int nextLine = 2;
+        for (size_t i = 0; i < version; ++i)
+        {
+            nextLine += code[i] == '\n' ? 1 : 0;
+        }
+        return code.substr(0, lineEnd + 1) + block + "#line " + std::to_string(nextLine) + " 0\n" +
+               code.substr(lineEnd + 1);
+    }
+};
+
+#endif
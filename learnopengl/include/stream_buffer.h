@@ -0,0 +1,305 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include <gl_ext.h>
+
+// frames the GPU may still be reading from while the CPU writes the next one
+const unsigned int STREAM_BUFFER_FRAMES = 3;
+// how long BeginFrame waits on a fence at a time, in nanoseconds
+const GLuint64 STREAM_BUFFER_WAIT_TIMEOUT = 1000000;
+
+enum class StreamBufferMode
+{
+    // one region per frame in flight in a buffer mapped once for good (buffer storage), fences
+    // keep the CPU from overwriting a region the GPU still reads
+    Persistent,
+    // the same regions and fences, but each frame maps its region unsynchronized and unmaps it
+    // before drawing, for GL 3.3 contexts without buffer storage
+    Unsynchronized,
+    // one region, orphaned by mapping it with GL_MAP_INVALIDATE_BUFFER_BIT every frame; the
+    // driver hands out fresh memory and keeps the old until the GPU is done with it
+    Orphaning,
+};
+
+/// <summary>
+/// Memory for transient data handed out by StreamBuffer::Allocate. Offset is the position in the
+/// GL buffer to bind or point attributes at.
+/// </summary>
+struct StreamAllocation
+{
+    void *Data = nullptr; // nullptr if the frame ran out of space
+    size_t Offset = 0;
+    size_t Size = 0;
+};
+
+/// <summary>
+/// A ring buffer for data that is written once per frame and read by that frame's draws, like
+/// camera and per object constants or instance data. Allocating is a bump of an offset into mapped
+/// memory; the GPU is only waited for when it is a full STREAM_BUFFER_FRAMES behind.
+///
+/// A frame is BeginFrame, any number of Allocate, then Commit before the draws that read the data.
+/// Those draws have to be issued before the next BeginFrame.
+/// </summary>
+struct StreamBuffer
+{
+public:
+    /// <summary>
+    /// Creates a buffer for target with frameCapacity bytes per frame. Persistent falls back to
+    /// Unsynchronized when the context has no buffer storage.
+    /// </summary>
+    StreamBuffer(GLenum target,
+                 size_t frameCapacity,
+                 StreamBufferMode mode = StreamBufferMode::Persistent)
+        : Target(target), Mode(mode)
+    {
+        if (Mode == StreamBufferMode::Persistent && !GLExtensions::Get().HasBufferStorage)
+        {
+            Mode = StreamBufferMode::Unsynchronized;
+        }
+        // every region starts aligned for any use of the buffer, uniform blocks being the strictest
+        size_t alignment = GetUniformAlignment();
+        FrameCapacity = (frameCapacity + alignment - 1) / alignment * alignment;
+        size_t regions = Mode == StreamBufferMode::Orphaning ? 1 : STREAM_BUFFER_FRAMES;
+
+        glGenBuffers(1, &Buffer);
+        glBindBuffer(Target, Buffer);
+        if (Mode == StreamBufferMode::Persistent)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            GLExtensions::Get().BufferStorage(Target, FrameCapacity * regions, NULL, flags);
+            Mapped = static_cast<unsigned char *>(
+                glMapBufferRange(Target, 0, FrameCapacity * regions, flags));
+            if (Mapped == nullptr)
+            {
+                std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+            }
+        }
+        else
+        {
+            glBufferData(Target, FrameCapacity * regions, NULL, GL_STREAM_DRAW);
+        }
+        glBindBuffer(Target, 0);
+    }
+
+    ~StreamBuffer()
+    {
+        if (Mapped != nullptr)
+        {
+            glBindBuffer(Target, Buffer);
+            glUnmapBuffer(Target);
+            glBindBuffer(Target, 0);
+        }
+        for (GLsync &fence : Fences)
+        {
+            glDeleteSync(fence);
+        }
+        glDeleteBuffers(1, &Buffer);
+    }
+
+    // holds a mapping of its buffer and fences for it, it stays where it was created
+    StreamBuffer(const StreamBuffer &) = delete;
+    StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+    /// <summary>
+    /// Starts writing a frame: fences the region of the last frame, moves on to the next region
+    /// and waits until the GPU is done reading it.
+    /// </summary>
+    void BeginFrame()
+    {
+        if (Writing)
+        {
+            Commit();
+        }
+        if (Started && Mode != StreamBufferMode::Orphaning)
+        {
+            // the draws of the last frame were all issued before this
+            Fences[Frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            Frame = (Frame + 1) % STREAM_BUFFER_FRAMES;
+            WaitForRegion(Frame);
+        }
+        Started = true;
+        Writing = true;
+        Used = 0;
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+        if (Mode == StreamBufferMode::Unsynchronized)
+        {
+            flags |= GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+            glBindBuffer(Target, Buffer);
+            Mapped = static_cast<unsigned char *>(
+                glMapBufferRange(Target, GetRegionOffset(), FrameCapacity, flags));
+        }
+        else if (Mode == StreamBufferMode::Orphaning)
+        {
+            flags |= GL_MAP_INVALIDATE_BUFFER_BIT;
+            glBindBuffer(Target, Buffer);
+            Mapped =
+                static_cast<unsigned char *>(glMapBufferRange(Target, 0, FrameCapacity, flags));
+        }
+        if (Mapped == nullptr)
+        {
+            std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+        }
+    }
+
+    /// <summary>
+    /// Hands out size bytes of the current frame, offset by a multiple of alignment. Returns an
+    /// empty allocation when the frame is out of space or not writing.
+    /// </summary>
+    StreamAllocation Allocate(size_t size, size_t alignment = 16)
+    {
+        size_t offset = (Used + alignment - 1) / alignment * alignment;
+        if (!Writing || Mapped == nullptr || offset + size > FrameCapacity)
+        {
+            std::cout << "ERROR::STREAM_BUFFER::OUT_OF_SPACE: " << size << " bytes at " << Used
+                      << " of " << FrameCapacity << std::endl;
+            return StreamAllocation();
+        }
+        Used = offset + size;
+
+        // a persistent mapping covers every region, the others only the current one
+        unsigned char *region =
+            Mode == StreamBufferMode::Persistent ? Mapped + GetRegionOffset() : Mapped;
+        StreamAllocation allocation;
+        allocation.Data = region + offset;
+        allocation.Offset = GetRegionOffset() + offset;
+        allocation.Size = size;
+        return allocation;
+    }
+
+    /// <summary>
+    /// Allocates and copies count values in one go.
+    /// </summary>
+    template <typename T>
+    StreamAllocation Write(const T *values, size_t count, size_t alignment = alignof(T))
+    {
+        StreamAllocation allocation = Allocate(count * sizeof(T), alignment);
+        if (allocation.Data != nullptr)
+        {
+            std::memcpy(allocation.Data, values, allocation.Size);
+        }
+        return allocation;
+    }
+
+    /// <summary>
+    /// Ends the writes of the frame, the data can be drawn from after this.
+    /// </summary>
+    void Commit()
+    {
+        if (!Writing)
+        {
+            return;
+        }
+        Writing = false;
+        if (Mode == StreamBufferMode::Persistent || Mapped == nullptr)
+        {
+            return; // the coherent mapping makes every write visible by itself
+        }
+        glBindBuffer(Target, Buffer);
+        if (Used > 0)
+        {
+            glFlushMappedBufferRange(Target, 0, Used);
+        }
+        glUnmapBuffer(Target);
+        Mapped = nullptr;
+    }
+
+    /// <summary>
+    /// Binds an allocation to an indexed binding point of the buffer's target, like a uniform
+    /// block binding.
+    /// </summary>
+    void BindRange(unsigned int binding, const StreamAllocation &allocation) const
+    {
+        glBindBufferRange(Target,
+                          binding,
+                          Buffer,
+                          static_cast<GLintptr>(allocation.Offset),
+                          static_cast<GLsizeiptr>(allocation.Size));
+    }
+
+    unsigned int GetBuffer() const
+    {
+        return Buffer;
+    }
+
+    StreamBufferMode GetMode() const
+    {
+        return Mode;
+    }
+
+    size_t GetFrameCapacity() const
+    {
+        return FrameCapacity;
+    }
+
+    /// <summary>
+    /// How often BeginFrame had to wait for the GPU, a sign that the frames in flight are too few.
+    /// </summary>
+    unsigned int GetStallCount() const
+    {
+        return StallCount;
+    }
+
+    /// <summary>
+    /// The offset alignment the context requires for glBindBufferRange on uniform buffers.
+    /// </summary>
+    static size_t GetUniformAlignment()
+    {
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        return alignment > 0 ? static_cast<size_t>(alignment) : 256;
+    }
+
+private:
+    GLenum Target;
+    StreamBufferMode Mode;
+    size_t FrameCapacity = 0; // bytes per region
+    unsigned int Buffer = 0;
+    unsigned char *Mapped = nullptr; // all regions when persistent, else the current one or null
+    GLsync Fences[STREAM_BUFFER_FRAMES] = {};
+    unsigned int Frame = 0; // region being written
+    size_t Used = 0;        // bytes of the region handed out
+    bool Started = false;
+    bool Writing = false;
+    unsigned int StallCount = 0;
+
+    size_t GetRegionOffset() const
+    {
+        return Mode == StreamBufferMode::Orphaning ? 0 : Frame * FrameCapacity;
+    }
+
+    void WaitForRegion(unsigned int region)
+    {
+        GLsync &fence = Fences[region];
+        if (fence == nullptr)
+        {
+            return;
+        }
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED)
+        {
+            ++StallCount;
+            // flush once so the fence is sure to be reached, then wait in slices
+            GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            do
+            {
+                result = glClientWaitSync(fence, flags, STREAM_BUFFER_WAIT_TIMEOUT);
+                flags = 0;
+            } while (result == GL_TIMEOUT_EXPIRED);
+        }
+        if (result == GL_WAIT_FAILED)
+        {
+            std::cout << "ERROR::STREAM_BUFFER::WAIT_FAILED" << std::endl;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+
+using std::string;
+
+/// <summary>
+/// Process wide cache of loaded textures, shared by every Model. Textures are keyed by their
+/// canonical file path and gamma setting, so two models referencing the same file by different
+/// relative paths still share one GPU texture. Each user holds a reference and the texture is
+/// deleted when the last one is released.
+/// </summary>
+struct TextureCache
+{
+public:
+    static TextureCache &Get()
+    {
+        static TextureCache instance;
+        return instance;
+    }
+
+    /// <summary>
+    /// Builds the cache key of a texture file.
+    /// </summary>
+    static string MakeKey(const string &path, bool gamma)
+    {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        string key = error ? std::filesystem::path(path).lexically_normal().generic_string()
+                           : canonical.generic_string();
+        key += gamma ? "|srgb" : "|linear";
+        return key;
+    }
+
+    /// <summary>
+    /// Looks up a texture and takes a reference to it. Returns 0 if it isn't loaded.
+    /// </summary>
+    unsigned int Acquire(const string &key)
+    {
+        auto it = Entries.find(key);
+        if (it == Entries.end())
+        {
+            return 0;
+        }
+        ++it->second.RefCount;
+        return it->second.ID;
+    }
+
+    /// <summary>
+    /// Registers a freshly uploaded texture, the caller holds the first reference.
+    /// </summary>
+    void Add(const string &key, unsigned int id)
+    {
+        Entries[key] = Entry{id, 1};
+        Keys[id] = key;
+    }
+
+    /// <summary>
+    /// Drops a reference, deleting the texture once nobody uses it anymore.
+    /// </summary>
+    void Release(unsigned int id)
+    {
+        auto keyIt = Keys.find(id);
+        if (keyIt == Keys.end())
+        {
+            return;
+        }
+        auto it = Entries.find(keyIt->second);
+        if (--it->second.RefCount == 0)
+        {
+            glDeleteTextures(1, &id);
+            Entries.erase(it);
+            Keys.erase(keyIt);
+        }
+    }
+
+    size_t GetTextureCount() const
+    {
+        return Entries.size();
+    }
+
+private:
+    struct Entry
+    {
+        unsigned int ID;
+        unsigned int RefCount;
+    };
+
+    std::unordered_map<string, Entry> Entries;
+    std::unordered_map<unsigned int, string> Keys; // texture ID -> key, for releasing
+};
+
+#endif
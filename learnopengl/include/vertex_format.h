@@ -0,0 +1,392 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using std::vector;
+
+#define MAX_BONE_INFLUENCE 4
+
+struct Vertex
+{
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+    glm::vec3 Tangent;
+    glm::vec3 Bitangent;
+
+    // bone indices which will influence this vertex
+    int BoneIDs[MAX_BONE_INFLUENCE];
+
+    // weights from each bone
+    float Weights[MAX_BONE_INFLUENCE];
+};
+
+/// <summary>
+/// How a mesh stores its vertices on the GPU. The CPU side always keeps the full Vertex.
+/// </summary>
+enum class VertexFormat
+{
+    // every Vertex field as 32 bit values, 88 bytes per vertex
+    Full,
+    // quantized CompactVertex, 20 bytes per vertex (32 with bones)
+    Compact
+};
+
+// Compact layout. Everything is decoded by the fixed function attribute fetch, so shaders read the
+// same vec3/vec2 inputs at the same locations as with the full layout:
+// 0 position:  half float xyz (+ padding)
+// 1 normal:    signed normalized 10:10:10:2
+// 2 texcoords: unsigned normalized 16 bit, or half float if they leave [0, 1]
+// 3 tangent:   signed normalized 10:10:10:2, w holds the bitangent sign
+// 4 bitangent: not stored, reconstruct it as cross(normal, tangent.xyz) * sign(tangent.w); GL
+//              3.3 decodes the 2 bit -1 as -1/3. The attribute is disabled, so a shader that still
+//              reads aBitangent gets the default (0, 0, 0, 1)
+// 5 bone ids:  16 bit integers, only for meshes with bones
+// 6 weights:   unsigned normalized 8 bit, only for meshes with bones
+struct CompactVertex
+{
+    uint16_t Position[4];
+    uint32_t Normal;
+    uint16_t TexCoords[2];
+    uint32_t Tangent;
+};
+
+struct CompactSkinnedVertex
+{
+    CompactVertex Base;
+    int16_t BoneIDs[MAX_BONE_INFLUENCE];
+    uint8_t Weights[MAX_BONE_INFLUENCE];
+};
+
+// Half floats keep 11 significant bits, so rounding moves a coordinate by up to about 1/2048 of
+// its own magnitude: half a unit at 1024, a whole unit at 2048. Whether that shows depends on the
+// size of the mesh, so a mesh only gets half float positions if the rounding at its largest
+// coordinate stays below this fraction of its extent, otherwise it keeps full floats.
+const float COMPACT_POSITION_TOLERANCE = 1.0f / 1024.0f;
+const float HALF_FLOAT_MAX = 65504.0f;
+
+/// <summary>
+/// The vertex layout a mesh actually ended up with.
+/// </summary>
+struct VertexLayout
+{
+    VertexFormat Format = VertexFormat::Full;
+    bool HasBones = true;
+    bool UnormTexCoords = false;
+    GLsizei Stride = sizeof(Vertex);
+};
+
+/// <summary>
+/// Converts a float to IEEE half precision, rounding to nearest even.
+/// </summary>
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000u;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xffu) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffffu;
+
+    if (exponent >= 31)
+    {
+        // overflow, infinity and nan all become infinity (nan keeps a mantissa bit)
+        bool isNan = ((bits >> 23) & 0xffu) == 0xffu && mantissa != 0;
+        return static_cast<uint16_t>(sign | 0x7c00u | (isNan ? 0x200u : 0u));
+    }
+    if (exponent <= 0)
+    {
+        if (exponent < -10)
+        {
+            return static_cast<uint16_t>(sign); // too small, flush to zero
+        }
+        // denormal, shift in the implicit leading one
+        mantissa |= 0x800000u;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1u);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u)))
+        {
+            ++half;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1fffu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u)))
+    {
+        ++half; // may carry into the exponent, which is still the correctly rounded result
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+/// <summary>
+/// Packs a vector with components in [-1, 1] into signed normalized 10:10:10:2.
+/// </summary>
+inline uint32_t PackSnorm1010102(glm::vec3 value, float w)
+{
+    auto pack = [](float component, float scale, uint32_t mask) -> uint32_t
+    {
+        float clamped = component < -1.0f ? -1.0f : (component > 1.0f ? 1.0f : component);
+        int32_t quantized = static_cast<int32_t>(std::lround(clamped * scale));
+        return static_cast<uint32_t>(quantized) & mask;
+    };
+    return pack(value.x, 511.0f, 0x3ffu) | (pack(value.y, 511.0f, 0x3ffu) << 10) |
+           (pack(value.z, 511.0f, 0x3ffu) << 20) | (pack(w, 1.0f, 0x3u) << 30);
+}
+
+inline uint16_t PackUnorm16(float value)
+{
+    float clamped = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<uint16_t>(std::lround(clamped * 65535.0f));
+}
+
+/// <summary>
+/// Returns the largest error rounding a value of up to magnitude to half precision makes, half the
+/// spacing of the halves around it.
+/// </summary>
+inline float GetHalfRoundingError(float magnitude)
+{
+    int exponent;
+    std::frexp(magnitude, &exponent); // magnitude is in [2^(exponent - 1), 2^exponent)
+    // denormal halves below 2^-14 are evenly spaced by 2^-24
+    return std::ldexp(1.0f, std::max(exponent - 12, -25));
+}
+
+/// <summary>
+/// Picks the layout for a mesh. Compact is only used when half float positions are precise enough
+/// for the mesh's size, see COMPACT_POSITION_TOLERANCE. Bone attributes are dropped when the
+/// source mesh has no bones.
+/// </summary>
+inline VertexLayout ChooseVertexLayout(const vector<Vertex> &vertices,
+                                       VertexFormat format,
+                                       bool hasBones)
+{
+    VertexLayout layout;
+    if (format != VertexFormat::Compact)
+    {
+        return layout;
+    }
+
+    bool unormTexCoords = true;
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    float magnitude = 0.0f;
+    for (const Vertex &vertex : vertices)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            float position = vertex.Position[i];
+            if (!(std::fabs(position) <= HALF_FLOAT_MAX))
+            {
+                return layout; // out of half range, or nan
+            }
+            boundsMin[i] = std::min(boundsMin[i], position);
+            boundsMax[i] = std::max(boundsMax[i], position);
+            magnitude = std::max(magnitude, std::fabs(position));
+        }
+        unormTexCoords = unormTexCoords && vertex.TexCoords.x >= 0.0f &&
+                         vertex.TexCoords.x <= 1.0f && vertex.TexCoords.y >= 0.0f &&
+                         vertex.TexCoords.y <= 1.0f;
+    }
+    if (!vertices.empty())
+    {
+        glm::vec3 size = boundsMax - boundsMin;
+        float extent = std::max(size.x, std::max(size.y, size.z));
+        if (GetHalfRoundingError(magnitude) > extent * COMPACT_POSITION_TOLERANCE)
+        {
+            return layout;
+        }
+    }
+
+    layout.Format = VertexFormat::Compact;
+    layout.HasBones = hasBones;
+    layout.UnormTexCoords = unormTexCoords;
+    layout.Stride = hasBones ? sizeof(CompactSkinnedVertex) : sizeof(CompactVertex);
+    return layout;
+}
+
+/// <summary>
+/// Combines the layouts chosen for two meshes into one both can share. Compact is kept only if both
+/// meshes fit it, bones are kept if either mesh has them.
+/// </summary>
+inline VertexLayout MergeVertexLayouts(const VertexLayout &a, const VertexLayout &b)
+{
+    if (a.Format != VertexFormat::Compact || b.Format != VertexFormat::Compact)
+    {
+        return VertexLayout();
+    }
+    VertexLayout layout = a;
+    layout.HasBones = a.HasBones || b.HasBones;
+    layout.UnormTexCoords = a.UnormTexCoords && b.UnormTexCoords;
+    layout.Stride = layout.HasBones ? sizeof(CompactSkinnedVertex) : sizeof(CompactVertex);
+    return layout;
+}
+
+/// <summary>
+/// Quantizes vertices into the compact layout, returns the bytes ready for glBufferData.
+/// </summary>
+inline vector<unsigned char> EncodeCompactVertices(const vector<Vertex> &vertices,
+                                                   const VertexLayout &layout)
+{
+    vector<unsigned char> bytes(vertices.size() * layout.Stride);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vertex &vertex = vertices[i];
+
+        CompactSkinnedVertex encoded = {};
+        CompactVertex &base = encoded.Base;
+        base.Position[0] = FloatToHalf(vertex.Position.x);
+        base.Position[1] = FloatToHalf(vertex.Position.y);
+        base.Position[2] = FloatToHalf(vertex.Position.z);
+        base.Position[3] = FloatToHalf(1.0f);
+        base.Normal = PackSnorm1010102(vertex.Normal, 0.0f);
+        // the bitangent is only kept as the handedness of the tangent frame
+        float handedness =
+            glm::dot(glm::cross(vertex.Normal, vertex.Tangent), vertex.Bitangent) < 0.0f ? -1.0f
+                                                                                        : 1.0f;
+        base.Tangent = PackSnorm1010102(vertex.Tangent, handedness);
+        for (int j = 0; j < 2; ++j)
+        {
+            base.TexCoords[j] = layout.UnormTexCoords ? PackUnorm16(vertex.TexCoords[j])
+                                                      : FloatToHalf(vertex.TexCoords[j]);
+        }
+
+        if (layout.HasBones)
+        {
+            for (int j = 0; j < MAX_BONE_INFLUENCE; ++j)
+            {
+                encoded.BoneIDs[j] = static_cast<int16_t>(vertex.BoneIDs[j]);
+                float weight = vertex.Weights[j] < 0.0f ? 0.0f : vertex.Weights[j];
+                encoded.Weights[j] =
+                    static_cast<uint8_t>(std::lround((weight > 1.0f ? 1.0f : weight) * 255.0f));
+            }
+        }
+
+        std::memcpy(&bytes[i * layout.Stride], &encoded, layout.Stride);
+    }
+    return bytes;
+}
+
+/// <summary>
+/// Sets the attribute pointers of the bound VAO for the vertex buffer currently bound to
+/// GL_ARRAY_BUFFER, starting baseOffset bytes into it.
+/// </summary>
+inline void SetupVertexAttributes(const VertexLayout &layout, size_t baseOffset = 0)
+{
+    GLsizei stride = layout.Stride;
+    auto at = [baseOffset](size_t offset) { return (void *)(baseOffset + offset); };
+
+    if (layout.Format == VertexFormat::Compact)
+    {
+        // vertex Positions
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(
+            0, 3, GL_HALF_FLOAT, GL_FALSE, stride, at(offsetof(CompactVertex, Position)));
+        // vertex normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(
+            1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, at(offsetof(CompactVertex, Normal)));
+        // vertex texture coords
+        glEnableVertexAttribArray(2);
+        if (layout.UnormTexCoords)
+        {
+            glVertexAttribPointer(
+                2, 2, GL_UNSIGNED_SHORT, GL_TRUE, stride, at(offsetof(CompactVertex, TexCoords)));
+        }
+        else
+        {
+            glVertexAttribPointer(
+                2, 2, GL_HALF_FLOAT, GL_FALSE, stride, at(offsetof(CompactVertex, TexCoords)));
+        }
+        // vertex tangent, with the bitangent sign in w
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(
+            3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, at(offsetof(CompactVertex, Tangent)));
+        // no bitangent stream, location 4 reads as (0, 0, 0, 1)
+        glDisableVertexAttribArray(4);
+
+        if (layout.HasBones)
+        {
+            // ids
+            glEnableVertexAttribArray(5);
+            glVertexAttribIPointer(
+                5, 4, GL_SHORT, stride, at(offsetof(CompactSkinnedVertex, BoneIDs)));
+            // weights
+            glEnableVertexAttribArray(6);
+            glVertexAttribPointer(6,
+                                  4,
+                                  GL_UNSIGNED_BYTE,
+                                  GL_TRUE,
+                                  stride,
+                                  at(offsetof(CompactSkinnedVertex, Weights)));
+        }
+        else
+        {
+            glDisableVertexAttribArray(5);
+            glDisableVertexAttribArray(6);
+        }
+        return;
+    }
+
+    // set the vertex attribute pointers
+    // vertex Positions
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, at(offsetof(Vertex, Position)));
+    // vertex normals
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, at(offsetof(Vertex, Normal)));
+    // vertex texture coords
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, at(offsetof(Vertex, TexCoords)));
+    // vertex tangent
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, at(offsetof(Vertex, Tangent)));
+    // vertex bitangent
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, at(offsetof(Vertex, Bitangent)));
+    // ids
+    glEnableVertexAttribArray(5);
+    glVertexAttribIPointer(5, 4, GL_INT, stride, at(offsetof(Vertex, BoneIDs)));
+    // weights
+    glEnableVertexAttribArray(6);
+    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, stride, at(offsetof(Vertex, Weights)));
+}
+
+// first of the four attribute locations an instance's model matrix takes, one column each
+const unsigned int INSTANCE_TRANSFORM_LOCATION = 7;
+
+/// <summary>
+/// Sets the per instance model matrix attributes of the bound VAO for the instance buffer
+/// currently bound to GL_ARRAY_BUFFER. A mat4 attribute is four vec4 columns, each advancing once
+/// per instance instead of once per vertex.
+/// </summary>
+inline void SetupInstanceAttributes()
+{
+    for (unsigned int column = 0; column < 4; ++column)
+    {
+        unsigned int location = INSTANCE_TRANSFORM_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location,
+                              4,
+                              GL_FLOAT,
+                              GL_FALSE,
+                              sizeof(glm::mat4),
+                              (void *)(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+#endif
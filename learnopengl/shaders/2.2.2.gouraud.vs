@@ -8,8 +8,12 @@ uniform vec3 lightPos; // we now define the uniform in the vertex shader and pas
 uniform vec3 lightColor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+layout (std140) uniform Matrices
+{
+    mat4 projection;
+    mat4 view;
+};
 
 void main()
 {
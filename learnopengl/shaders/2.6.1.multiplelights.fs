@@ -1,6 +1,20 @@
 #version 330 core
 out vec4 FragColor;
 
+// Keywords, defined by the permutation that is built (see ShaderLibrary::GetPermutation):
+// DIRECTIONAL_LIGHT, POINT_LIGHTS (NUM_POINT_LIGHTS of them) and SPOT_LIGHT switch the light
+// types on. Without any of them every type is on, as in the original multiple lights scene.
+#if !defined(DIRECTIONAL_LIGHT) && !defined(POINT_LIGHTS) && !defined(SPOT_LIGHT)
+#define DIRECTIONAL_LIGHT
+#define POINT_LIGHTS
+#define SPOT_LIGHT
+#endif
+#ifndef NUM_POINT_LIGHTS
+#define NUM_POINT_LIGHTS 4
+#endif
+
+#include "2.6.1.lighting.glsl"
+
 struct Material 
 {
     sampler2D diffuse;
@@ -8,44 +22,6 @@ struct Material
     float shininess;
 };
 
-struct DirectionalLight 
-{
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight
-{
-    vec3 position;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-};
-#define NUM_POINT_LIGHTS 4
-
-struct SpotLight {
-    vec3 position;
-    vec3 direction;
-    float cutOff;
-    float outerCutOff;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-};
-
 // inputs
 in vec2 TexCoords;
 in vec3 FragPos;
@@ -54,106 +30,45 @@ in vec3 Normal;
 // uniforms
 uniform vec3 viewPos;
 uniform Material material;
+#ifdef DIRECTIONAL_LIGHT
 uniform DirectionalLight directionalLight;
+#endif
+#ifdef POINT_LIGHTS
 uniform PointLight pointLights[NUM_POINT_LIGHTS];
+#endif
+#ifdef SPOT_LIGHT
 uniform SpotLight spotLight;
-
-// function prototypes
-vec3 CalculateDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir);
-vec3 CalculatePointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
-vec3 CalculateSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+#endif
 
 void main()
 {
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(viewPos - FragPos);
 
+    Surface surface;
+    surface.diffuse = vec3(texture(material.diffuse, TexCoords));
+    surface.specular = vec3(texture(material.specular, TexCoords));
+    surface.shininess = material.shininess;
+
+    vec3 result = vec3(0.0);
+
+#ifdef DIRECTIONAL_LIGHT
     // Directional Light influence
-    vec3 result = CalculateDirectionalLight(directionalLight, norm, viewDir);
+    result += CalculateDirectionalLight(directionalLight, surface, norm, viewDir);
+#endif
 
+#ifdef POINT_LIGHTS
     // Point Light influence
     for (int i = 0; i < NUM_POINT_LIGHTS; ++i)
     {
-        result += CalculatePointLight(pointLights[i], norm, FragPos, viewDir);
+        result += CalculatePointLight(pointLights[i], surface, norm, FragPos, viewDir);
     }
+#endif
 
+#ifdef SPOT_LIGHT
     // Other lights (i.e. spotlights)
-    result += CalculateSpotLight(spotLight, norm, FragPos, viewDir);
+    result += CalculateSpotLight(spotLight, surface, norm, FragPos, viewDir);
+#endif
 
     FragColor = vec4(result, 1.0);
 }
-
-vec3 CalculateDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir)
-{
-    vec3 lightDir = normalize(-light.direction);
-
-    // diffuse
-    float diff = max(dot(normal, lightDir), 0.0);
-
-    // specular
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-
-    // combine the results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    return (ambient + diffuse + specular);
-}
-
-vec3 CalculatePointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-
-    // diffuse
-    float diff = max(dot(normal, lightDir), 0.0);
-
-    // specular
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-
-    // attenuation
-    float distance = length(light.position - FragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-
-    // combine the results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
-
-    return (ambient + diffuse + specular);
-}
-
-vec3 CalculateSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
-{
-    vec3 lightDir = normalize(light.position - fragPos);
-    
-    // diffuse
-    float diff = max(dot(normal, lightDir), 0.0);
-
-    // specular
-    vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-
-    // attenuation
-    float distance = length(light.position - FragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
-
-    // spotlight (with soft edges)
-    float theta = dot(lightDir, normalize(-light.direction));
-    float epsilon = light.cutOff - light.outerCutOff;
-    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
-
-    // combine the results
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
-    ambient *= attenuation;
-    diffuse *= attenuation * intensity;
-    specular *= attenuation * intensity;
-
-    return (ambient + diffuse + specular);
-}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 7) in mat4 aInstanceModel;
+
+out vec2 TexCoords;
+
+layout (std140) uniform Matrices
+{
+    mat4 projection;
+    mat4 view;
+};
+
+uniform mat4 model; // world transform of the mesh's node inside the model
+
+void main()
+{
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * aInstanceModel * model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,43 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 5) in ivec4 aBoneIDs;
+layout (location = 6) in vec4 aWeights;
+
+out vec2 TexCoords;
+
+const int MAX_BONES = 100;
+const int MAX_BONE_INFLUENCE = 4;
+
+// filled by BoneMatrixBuffer, each matrix takes a vertex from mesh space to model space
+layout (std140) uniform BoneMatrices
+{
+    mat4 boneMatrices[MAX_BONES];
+};
+
+layout (std140) uniform Matrices
+{
+    mat4 projection;
+    mat4 view;
+};
+
+uniform mat4 model;
+
+void main()
+{
+    vec4 position = vec4(0.0);
+    float totalWeight = 0.0;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+    {
+        if (aBoneIDs[i] < 0 || aBoneIDs[i] >= MAX_BONES)
+            continue;
+        position += boneMatrices[aBoneIDs[i]] * vec4(aPos, 1.0) * aWeights[i];
+        totalWeight += aWeights[i];
+    }
+    // vertices no bone moves stay where they are
+    if (totalWeight == 0.0)
+        position = vec4(aPos, 1.0);
+
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * model * position;
+}
@@ -0,0 +1,20 @@
+#version 330 core
+out vec4 FragColor;
+
+// One keyword picks the color: RED, GREEN, BLUE or YELLOW.
+#if defined(RED)
+const vec4 COLOR = vec4(1.0, 0.0, 0.0, 1.0);
+#elif defined(GREEN)
+const vec4 COLOR = vec4(0.0, 1.0, 0.0, 1.0);
+#elif defined(BLUE)
+const vec4 COLOR = vec4(0.0, 0.0, 1.0, 1.0);
+#elif defined(YELLOW)
+const vec4 COLOR = vec4(1.0, 1.0, 0.0, 1.0);
+#else
+const vec4 COLOR = vec4(1.0, 0.0, 1.0, 1.0); // no keyword, stands out on purpose
+#endif
+
+void main()
+{
+    FragColor = COLOR;
+}
@@ -8,7 +8,11 @@ in VS_OUT {
 
 const float MAGNITUDE = 0.2;
 
-uniform mat4 projection;
+layout (std140) uniform Matrices
+{
+    mat4 projection;
+    mat4 view;
+};
 
 void GenerateLine(int index)
 {
@@ -71,10 +71,13 @@ int main()
     //stbi_set_flip_vertically_on_load(true);
 
     // Build and compile the shader program
-    Shader shaderRed("shaders/3.8.1.advanced_glsl.vs", "shaders/3.8.1.red.fs");
-    Shader shaderGreen("shaders/3.8.1.advanced_glsl.vs", "shaders/3.8.1.green.fs");
-    Shader shaderBlue("shaders/3.8.1.advanced_glsl.vs", "shaders/3.8.1.blue.fs");
-    Shader shaderYellow("shaders/3.8.1.advanced_glsl.vs", "shaders/3.8.1.yellow.fs");
+    // one fragment shader, the color is picked by a keyword
+    const char *vertexPath = "shaders/3.8.1.advanced_glsl.vs";
+    const char *colorPath = "shaders/3.8.1.color.fs";
+    Shader shaderRed(vertexPath, colorPath, nullptr, ShaderBuild::Immediate, {"RED"});
+    Shader shaderGreen(vertexPath, colorPath, nullptr, ShaderBuild::Immediate, {"GREEN"});
+    Shader shaderBlue(vertexPath, colorPath, nullptr, ShaderBuild::Immediate, {"BLUE"});
+    Shader shaderYellow(vertexPath, colorPath, nullptr, ShaderBuild::Immediate, {"YELLOW"});
 
     float cubeVertices[] = {
         // positions         
@@ -9,6 +9,8 @@
 #include <shader.h>
 #include <camera.h>
 #include <model.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
 
 // Function declerations
 void ProcessInput(GLFWwindow *window);
@@ -64,6 +66,7 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // Configure global OpenGL state
     glEnable(GL_DEPTH_TEST);
@@ -209,6 +212,9 @@ int main()
     // uncomment to enable wireframes
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // the camera of every program, uploaded once per frame
+    FrameUniforms frameUniforms;
+
     // Main Loop
     while (!glfwWindowShouldClose(window))
     {
@@ -230,8 +236,7 @@ int main()
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 projection = glm::perspective(glm::radians(camera.FoV), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 0.1f, 100.0f);
         shader.SetMat4x4("model", model);
-        shader.SetMat4x4("view", view);
-        shader.SetMat4x4("projection", projection);
+        frameUniforms.Upload(projection, view);
         // cubes
         glBindVertexArray(cubeVAO);
         glActiveTexture(GL_TEXTURE0);
@@ -242,9 +247,6 @@ int main()
         // draw skybox as last
         glDepthFunc(GL_LEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
         skyboxShader.Use();
-        view = glm::mat4(glm::mat3(camera.GetViewMatrix())); // remove translation from the view matrix
-        skyboxShader.SetMat4x4("view", view);
-        skyboxShader.SetMat4x4("projection", projection);
         // skybox cube
         glBindVertexArray(skyboxVAO);
         glActiveTexture(GL_TEXTURE0);
@@ -9,6 +9,8 @@
 #include <shader.h>
 #include <camera.h>
 #include <model.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
 
 // Function declerations
 void ProcessInput(GLFWwindow *window);
@@ -63,6 +65,7 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // Configure global OpenGL state
     glEnable(GL_DEPTH_TEST);
@@ -202,6 +205,9 @@ int main()
     // uncomment to enable wireframes
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // the camera of every program, uploaded once per frame
+    FrameUniforms frameUniforms;
+
     // Main Loop
     while (!glfwWindowShouldClose(window))
     {
@@ -233,8 +239,7 @@ int main()
                                                 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 model = glm::mat4(1.0f);
-        shader.SetMat4x4("projection", projection);
-        shader.SetMat4x4("view", view);
+        frameUniforms.Upload(projection, view);
         // cubes
         glBindVertexArray(cubeVAO);
         glActiveTexture(GL_TEXTURE0);
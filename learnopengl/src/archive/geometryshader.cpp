@@ -9,6 +9,8 @@
 #include <shader.h>
 #include <camera.h>
 #include <model.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
 
 // Function declerations
 void ProcessInput(GLFWwindow *window);
@@ -64,6 +66,7 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // Configure global OpenGL state
     glEnable(GL_DEPTH_TEST);
@@ -82,6 +85,9 @@ int main()
     // uncomment to enable wireframes
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // the camera of every program, uploaded once per frame
+    FrameUniforms frameUniforms;
+
     // Main Loop
     while (!glfwWindowShouldClose(window))
     {
@@ -101,20 +107,14 @@ int main()
         glm::mat4 view = camera.GetViewMatrix();;
         glm::mat4 model = glm::mat4(1.0f);
         shader.Use();
-        shader.SetMat4x4("projection", projection);
-        shader.SetMat4x4("view", view);
-        shader.SetMat4x4("model", model);
+        frameUniforms.Upload(projection, view);
 
         // draw model as usual
-        backpack.Draw(shader);
+        backpack.Draw(shader, model);
 
         // then draw model with normal visualizing geometry shader
         normalShader.Use();
-        normalShader.SetMat4x4("projection", projection);
-        normalShader.SetMat4x4("view", view);
-        normalShader.SetMat4x4("model", model);
-
-        backpack.Draw(normalShader);
+        backpack.Draw(normalShader, model);
 
         // Swaps the 2d buffer that contains color values for each pixel
         glfwSwapBuffers(window);
@@ -9,6 +9,8 @@
 #include <shader.h>
 #include <camera.h>
 #include <model.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
 
 // Function declerations
 void ProcessInput(GLFWwindow *window);
@@ -63,6 +65,7 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
     stbi_set_flip_vertically_on_load(true);
@@ -151,6 +154,9 @@ int main()
     // uncomment to enable wireframes
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    // the camera of every program, uploaded once per frame
+    FrameUniforms frameUniforms;
+
     // Main Loop
     while (!glfwWindowShouldClose(window))
     {
@@ -174,12 +180,9 @@ int main()
                                                 (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT,
                                                 0.1f,
                                                 100.0f);
-        shaderSingleColor.SetMat4x4("view", view);
-        shaderSingleColor.SetMat4x4("projection", projection);
+        frameUniforms.Upload(projection, view);
 
         shader.Use();
-        shader.SetMat4x4("view", view);
-        shader.SetMat4x4("projection", projection);
 
         // draw floor as normal, but don't write the floor to the stencil buffer, we only care about
         // the containers. We set its mask to 0x00 to not write to the stencil buffer.
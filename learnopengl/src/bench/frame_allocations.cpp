@@ -0,0 +1,103 @@
+#define ALLOCATION_STATS_IMPLEMENTATION
+#include <allocation_stats.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include <model.h>
+#include <render_queue.h>
+#include <shader.h>
+
+// Checks that drawing the backpack allocates nothing once the first frame has resolved every
+// material binding, both with Model::Draw and through the render queue. A few frames are drawn
+// to warm up, then the heap allocations of STEADY_FRAMES frames have to add up to zero.
+
+const int WARMUP_FRAMES = 2;
+const int STEADY_FRAMES = 100;
+
+template <typename DrawFrame>
+bool CheckFrameAllocations(const char *label, DrawFrame drawFrame);
+
+int main()
+{
+    // Initialize GLFW with a hidden window, only the context is needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    glEnable(GL_DEPTH_TEST);
+
+    bool passed = true;
+    {
+        Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+
+        stbi_set_flip_vertically_on_load(true);
+        Model backpack("models/backpack/backpack.obj");
+
+        glm::mat4 view = glm::lookAt(
+            glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 1.0f, 100.0f);
+        glm::mat4 model = glm::mat4(1.0f);
+
+        passed = CheckFrameAllocations("Model::Draw", [&]() {
+            shader.Use();
+            backpack.Draw(shader, model);
+        });
+
+        RenderQueue queue;
+        passed = CheckFrameAllocations("render queue", [&]() {
+                     queue.Begin(projection, view, 100.0f);
+                     backpack.Submit(queue, shader, model);
+                     queue.Flush();
+                 }) && passed;
+    }
+
+    glfwTerminate();
+    return passed ? 0 : 1;
+}
+
+/// <summary>
+/// Draws a few frames to warm up, then counts the allocations of the following ones.
+/// </summary>
+template <typename DrawFrame>
+bool CheckFrameAllocations(const char *label, DrawFrame drawFrame)
+{
+    for (int i = 0; i < WARMUP_FRAMES; ++i)
+    {
+        drawFrame();
+    }
+    glFinish();
+
+    size_t before = allocationStats.Count;
+    for (int i = 0; i < STEADY_FRAMES; ++i)
+    {
+        drawFrame();
+    }
+    size_t allocations = allocationStats.Count - before;
+    glFinish();
+
+    bool passed = allocations == 0;
+    std::cout << label << ": " << allocations << " allocations in " << STEADY_FRAMES
+              << " steady state frames: " << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed;
+}
@@ -0,0 +1,127 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include <frame_stats.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
+#include <model.h>
+#include <shader.h>
+
+// Renders a field of INSTANCE_GRID_SIZE^2 backpacks two ways: a loop setting the model matrix
+// uniform and calling Model::Draw per copy, and a single Model::DrawInstanced with the matrices in
+// an instance buffer. Prints the average frame time and the draw calls of each.
+
+const int INSTANCE_GRID_SIZE = 100; // 10000 backpacks
+const float INSTANCE_SPACING = 3.0f;
+const int FRAMES_PER_MODE = 20;
+
+const unsigned int BENCH_WIDTH = 1280;
+const unsigned int BENCH_HEIGHT = 720;
+
+int main()
+{
+    // Initialize GLFW with a hidden window, the default framebuffer still gets rendered to
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window =
+        glfwCreateWindow(BENCH_WIDTH, BENCH_HEIGHT, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    glViewport(0, 0, BENCH_WIDTH, BENCH_HEIGHT);
+    glEnable(GL_DEPTH_TEST);
+
+    {
+        Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+        Shader instancedShader("shaders/3.10.1.instancing.vs", "shaders/3.10.1.instancing.fs");
+
+        stbi_set_flip_vertically_on_load(true);
+        Model backpack("models/backpack/backpack.obj");
+
+        float extent = INSTANCE_GRID_SIZE * INSTANCE_SPACING;
+        glm::mat4 projection = glm::perspective(
+            glm::radians(45.0f), (float)BENCH_WIDTH / (float)BENCH_HEIGHT, 1.0f, extent * 2.0f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, extent * 0.5f, extent * 0.75f),
+                                     glm::vec3(0.0f),
+                                     glm::vec3(0.0f, 1.0f, 0.0f));
+
+        vector<glm::mat4> transforms;
+        transforms.reserve(INSTANCE_GRID_SIZE * INSTANCE_GRID_SIZE);
+        for (int x = 0; x < INSTANCE_GRID_SIZE; ++x)
+        {
+            for (int z = 0; z < INSTANCE_GRID_SIZE; ++z)
+            {
+                glm::vec3 offset((x - INSTANCE_GRID_SIZE / 2) * INSTANCE_SPACING,
+                                 0.0f,
+                                 (z - INSTANCE_GRID_SIZE / 2) * INSTANCE_SPACING);
+                transforms.push_back(glm::translate(glm::mat4(1.0f), offset));
+            }
+        }
+
+        // both programs read the camera from the same block
+        FrameUniforms frameUniforms;
+        frameUniforms.Upload(projection, view);
+
+        auto drawLoop = [&]() {
+            shader.Use();
+            for (const glm::mat4 &transform : transforms)
+            {
+                backpack.Draw(shader, transform);
+            }
+        };
+        auto drawInstanced = [&]() {
+            instancedShader.Use();
+            backpack.DrawInstanced(instancedShader, transforms);
+        };
+
+        // returns the average time of a frame in seconds, the first frame is a warmup
+        auto measure = [&](const char *label, auto drawFrame) {
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawFrame();
+            glFinish();
+
+            double start = glfwGetTime();
+            for (int i = 0; i < FRAMES_PER_MODE; ++i)
+            {
+                frameStats.Reset();
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                drawFrame();
+                glfwSwapBuffers(window);
+            }
+            glFinish();
+            double frameTime = (glfwGetTime() - start) / FRAMES_PER_MODE;
+
+            std::cout << label << ", " << transforms.size()
+                      << " backpacks: " << frameTime * 1000.0 << " ms per frame" << std::endl;
+            frameStats.Print();
+            return frameTime;
+        };
+
+        double loopTime = measure("loop of Model::Draw", drawLoop);
+        double instancedTime = measure("Model::DrawInstanced", drawInstanced);
+        std::cout << "speedup: " << loopTime / instancedTime << "x" << std::endl;
+    }
+
+    glfwTerminate();
+    return 0;
+}
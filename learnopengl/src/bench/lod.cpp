@@ -0,0 +1,128 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include <frame_stats.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
+#include <lod_selector.h>
+#include <model.h>
+#include <render_queue.h>
+#include <shader.h>
+
+// Draws a field of backpacks stretching away from the camera through the render queue, first at
+// full detail and then at the level of detail the LodSelector picks for each one, and prints the
+// frame time and triangles of both ways.
+
+const int FIELD_WIDTH = 10;
+const int FIELD_DEPTH = 40;
+const float FIELD_SPACING = 6.0f;
+const int VIEWPORT_SIZE = 1024;
+const int FRAMES_PER_MODE = 100;
+
+int main()
+{
+    // Initialize GLFW with a hidden window, rendering into its default framebuffer
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window =
+        glfwCreateWindow(VIEWPORT_SIZE, VIEWPORT_SIZE, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    glViewport(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE);
+    glEnable(GL_DEPTH_TEST);
+
+    {
+        Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+
+        stbi_set_flip_vertically_on_load(true);
+        ModelLoadOptions options;
+        options.GenerateLods = true;
+        Model backpack("models/backpack/backpack.obj", false, options);
+        for (size_t i = 0; i < backpack.Meshes.size(); ++i)
+        {
+            std::cout << "mesh " << i << ":";
+            for (const MeshLod &lod : backpack.Meshes[i].Lods)
+            {
+                std::cout << " " << lod.IndexCount / 3 << " triangles (error " << lod.Error << ")";
+            }
+            std::cout << std::endl;
+        }
+
+        // the camera looks down the field, most backpacks are far away and only a few pixels big
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 4.0f, 8.0f),
+                                     glm::vec3(0.0f, 0.0f, -20.0f),
+                                     glm::vec3(0.0f, 1.0f, 0.0f));
+        float farPlane = FIELD_DEPTH * FIELD_SPACING + 20.0f;
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, farPlane);
+        vector<glm::mat4> transforms;
+        for (int x = 0; x < FIELD_WIDTH; ++x)
+        {
+            for (int z = 0; z < FIELD_DEPTH; ++z)
+            {
+                glm::vec3 offset((x - FIELD_WIDTH / 2) * FIELD_SPACING, 0.0f, -z * FIELD_SPACING);
+                transforms.push_back(glm::translate(glm::mat4(1.0f), offset));
+            }
+        }
+
+        LodSelector selector;
+        selector.SetCamera(projection, view, static_cast<float>(VIEWPORT_SIZE));
+        RenderQueue queue;
+        FrameUniforms frameUniforms;
+
+        auto measure = [&](const char *label, const LodSelector *lods) {
+            queue.SetLodSelector(lods);
+
+            double start = glfwGetTime();
+            for (int frame = 0; frame < FRAMES_PER_MODE; ++frame)
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                frameStats.Reset();
+                frameUniforms.Upload(projection, view);
+                queue.Begin(projection, view, farPlane);
+                for (const glm::mat4 &transform : transforms)
+                {
+                    backpack.Submit(queue, shader, transform);
+                }
+                queue.Flush();
+            }
+            glFinish();
+            double frameTime = (glfwGetTime() - start) / FRAMES_PER_MODE;
+
+            std::cout << label << ", " << transforms.size() << " backpacks: " << frameTime * 1000.0
+                      << " ms per frame" << std::endl;
+            frameStats.Print();
+            return frameStats.TrianglesDrawn;
+        };
+
+        unsigned long long fullTriangles = measure("full detail", nullptr);
+        unsigned long long lodTriangles = measure("level of detail", &selector);
+        if (fullTriangles > 0)
+        {
+            std::cout << "level of detail draws " << 100.0 * lodTriangles / fullTriangles
+                      << "% of the triangles" << std::endl;
+        }
+    }
+
+    glfwTerminate();
+    return 0;
+}
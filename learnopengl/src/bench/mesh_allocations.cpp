@@ -0,0 +1,106 @@
+#define ALLOCATION_STATS_IMPLEMENTATION
+#include <allocation_stats.h>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <iostream>
+#include <map>
+
+#include <model.h>
+
+// Checks that loading a model allocates the CPU side vertex buffer of every mesh exactly once, both
+// when importing through assimp and when loading from the mesh cache. Allocations of at least
+// SIZE_LOG_THRESHOLD bytes are logged while the model loads, afterwards every mesh's vertex buffer
+// size has to show up exactly as often as there are meshes of that size.
+
+const size_t SIZE_LOG_THRESHOLD = 4096;
+
+bool CheckVertexAllocations(const char *label, bool useMeshCache);
+
+int main()
+{
+    // Initialize GLFW with a hidden window, only the context is needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    stbi_set_flip_vertically_on_load(true);
+
+    bool passed = CheckVertexAllocations("assimp import", false);
+    {
+        // make sure there is a cache for the second run
+        Model warmup("models/backpack/backpack.obj");
+    }
+    passed = CheckVertexAllocations("mesh cache", true) && passed;
+
+    glfwTerminate();
+    return passed ? 0 : 1;
+}
+
+/// <summary>
+/// Loads the backpack while logging allocation sizes and compares them to the loaded meshes.
+/// </summary>
+bool CheckVertexAllocations(const char *label, bool useMeshCache)
+{
+    ModelLoadOptions options;
+    options.UseMeshCache = useMeshCache;
+
+    allocationStats.StartSizeLog(SIZE_LOG_THRESHOLD);
+    size_t allocationsBefore = allocationStats.Count;
+    Model backpack("models/backpack/backpack.obj", false, options);
+    size_t allocations = allocationStats.Count - allocationsBefore;
+    allocationStats.StopSizeLog();
+
+    if (allocationStats.SizeLogLength > ALLOCATION_SIZE_LOG_CAPACITY)
+    {
+        std::cout << label << ": allocation size log overflowed, raise SIZE_LOG_THRESHOLD"
+                  << std::endl;
+        return false;
+    }
+
+    // meshes of equal size can't be told apart, so compare per size
+    std::map<size_t, size_t> expected;
+    for (const Mesh &mesh : backpack.Meshes)
+    {
+        size_t bytes = mesh.VertexCount * sizeof(Vertex);
+        if (bytes >= SIZE_LOG_THRESHOLD)
+        {
+            ++expected[bytes];
+        }
+    }
+
+    bool passed = true;
+    for (const auto &entry : expected)
+    {
+        size_t logged = allocationStats.CountLoggedSize(entry.first);
+        if (logged != entry.second)
+        {
+            std::cout << label << ": " << entry.second << " vertex buffer(s) of " << entry.first
+                      << " bytes were allocated " << logged << " times" << std::endl;
+            passed = false;
+        }
+    }
+
+    std::cout << label << ": " << backpack.Meshes.size() << " meshes, " << allocations
+              << " allocations in total, vertex buffers allocated once each: "
+              << (passed ? "PASS" : "FAIL") << std::endl;
+    return passed;
+}
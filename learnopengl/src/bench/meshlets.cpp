@@ -0,0 +1,114 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include <frame_stats.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
+#include <model.h>
+#include <render_queue.h>
+#include <shader.h>
+
+// Draws a ring of backpacks around the camera through the render queue, first mesh by mesh and
+// then with meshlet culling, and prints the frame time, triangles and culled meshlets of both
+// ways. The camera sits close inside the ring, so most backpacks are partly off screen and every
+// one shows the camera only one side.
+
+const int RING_COUNT = 24;
+const float RING_RADIUS = 6.0f;
+const int VIEWPORT_SIZE = 1024;
+const int FRAMES_PER_MODE = 100;
+
+int main()
+{
+    // Initialize GLFW with a hidden window, rendering into its default framebuffer
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window =
+        glfwCreateWindow(VIEWPORT_SIZE, VIEWPORT_SIZE, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    glViewport(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE); // the triangles meshlet culling drops would be culled here anyway
+
+    {
+        Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+
+        stbi_set_flip_vertically_on_load(true);
+        ModelLoadOptions options;
+        options.GenerateMeshlets = true;
+        Model backpack("models/backpack/backpack.obj", false, options);
+        size_t meshletCount = 0;
+        for (const Mesh &mesh : backpack.Meshes)
+        {
+            meshletCount += mesh.Meshlets.size();
+        }
+        std::cout << "backpack: " << backpack.Meshes.size() << " meshes, " << meshletCount
+                  << " meshlets" << std::endl;
+
+        glm::mat4 view = glm::lookAt(
+            glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        float farPlane = 100.0f;
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, farPlane);
+        vector<glm::mat4> transforms;
+        for (int i = 0; i < RING_COUNT; ++i)
+        {
+            float angle = glm::radians(360.0f * i / RING_COUNT);
+            glm::vec3 position(std::sin(angle) * RING_RADIUS, 0.0f, -std::cos(angle) * RING_RADIUS);
+            transforms.push_back(glm::translate(glm::mat4(1.0f), position));
+        }
+
+        RenderQueue queue;
+        FrameUniforms frameUniforms;
+
+        auto measure = [&](const char *label, bool cullMeshlets) {
+            queue.SetMeshletCulling(cullMeshlets);
+
+            double start = glfwGetTime();
+            for (int frame = 0; frame < FRAMES_PER_MODE; ++frame)
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                frameStats.Reset();
+                frameUniforms.Upload(projection, view);
+                queue.Begin(projection, view, farPlane);
+                for (const glm::mat4 &transform : transforms)
+                {
+                    backpack.Submit(queue, shader, transform);
+                }
+                queue.Flush();
+            }
+            glFinish();
+            double frameTime = (glfwGetTime() - start) / FRAMES_PER_MODE;
+
+            std::cout << label << ", " << transforms.size() << " backpacks: " << frameTime * 1000.0
+                      << " ms per frame" << std::endl;
+            frameStats.Print();
+        };
+
+        measure("whole meshes", false);
+        measure("meshlet culling", true);
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include <frame_stats.h>
+#include <model.h>
+#include <render_queue.h>
+#include <shader.h>
+
+// Draws a grid of backpacks, each once with the default shader and once with the normal
+// visualization, first immediately in scene order and then through the render queue, and prints
+// the state changes both ways cost.
+
+const int GRID_SIZE = 5;
+const float GRID_SPACING = 4.0f;
+
+int main()
+{
+    // Initialize GLFW with a hidden window, only the context is needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    glEnable(GL_DEPTH_TEST);
+
+    {
+        Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+        Shader normalShader("shaders/3.9.2.normal_visualization.vs",
+                            "shaders/3.9.2.normal_visualization.fs",
+                            "shaders/3.9.2.normal_visualization.gs");
+
+        stbi_set_flip_vertically_on_load(true);
+        Model backpack("models/backpack/backpack.obj");
+
+        glm::mat4 view = glm::lookAt(
+            glm::vec3(0.0f, 10.0f, 20.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        // wide enough that the whole grid is in view, so both ways draw the same meshes
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 1.0f, 100.0f);
+        vector<glm::mat4> transforms;
+        for (int x = 0; x < GRID_SIZE; ++x)
+        {
+            for (int z = 0; z < GRID_SIZE; ++z)
+            {
+                glm::vec3 offset(
+                    (x - GRID_SIZE / 2) * GRID_SPACING, 0.0f, (z - GRID_SIZE / 2) * GRID_SPACING);
+                transforms.push_back(glm::translate(glm::mat4(1.0f), offset));
+            }
+        }
+
+        // immediate: every model draws itself with both shaders, in scene order
+        frameStats.Reset();
+        for (const glm::mat4 &transform : transforms)
+        {
+            shader.Use();
+            backpack.Draw(shader, transform);
+            normalShader.Use();
+            backpack.Draw(normalShader, transform);
+        }
+        glFinish();
+        std::cout << "immediate, " << transforms.size() << " backpacks:" << std::endl;
+        frameStats.Print();
+
+        // queued: the same draws sorted by state
+        RenderQueue queue;
+        frameStats.Reset();
+        queue.Begin(projection, view, 100.0f);
+        for (const glm::mat4 &transform : transforms)
+        {
+            backpack.Submit(queue, shader, transform);
+            backpack.Submit(queue, normalShader, transform, RenderPass::Overlay);
+        }
+        queue.Flush();
+        glFinish();
+        std::cout << "render queue, " << transforms.size() << " backpacks:" << std::endl;
+        frameStats.Print();
+    }
+
+    glfwTerminate();
+    return 0;
+}
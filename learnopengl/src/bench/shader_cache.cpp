@@ -0,0 +1,112 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <iterator>
+
+#include <gl_ext.h>
+#include <program_cache.h>
+#include <shader.h>
+#include <shader_library.h>
+
+// Builds a set of the repo's programs three times: with the program binary cache turned off, then
+// with it on, which compiles and fills it on the first run and restores from it on every later
+// one, and once more with it on, which always restores. Then once more without the cache through a
+// ShaderLibrary, which submits every program before checking any. Prints the startup cost of each
+// pass. Many drivers keep a shader cache of their own, so the passes without it are only truly
+// cold after clearing that.
+
+struct ProgramSources
+{
+    const char *Vertex;
+    const char *Fragment;
+    const char *Geometry;
+};
+
+const ProgramSources PROGRAMS[] = {
+    {"shaders/2.6.1.multiplelights.vs", "shaders/2.6.1.multiplelights.fs", nullptr},
+    {"shaders/3.5.1.framebuffers.vs", "shaders/3.5.1.framebuffers.fs", nullptr},
+    {"shaders/3.5.1.framebuffers_screen.vs", "shaders/3.5.1.framebuffers_screen.fs", nullptr},
+    {"shaders/3.6.2.cubemaps.vs", "shaders/3.6.2.cubemaps.fs", nullptr},
+    {"shaders/3.6.2.skybox.vs", "shaders/3.6.2.skybox.fs", nullptr},
+    {"shaders/3.9.1.geometry_shader.vs",
+     "shaders/3.9.1.geometry_shader.fs",
+     "shaders/3.9.1.geometry_shader.gs"},
+    {"shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs", nullptr},
+    {"shaders/3.9.2.normal_visualization.vs",
+     "shaders/3.9.2.normal_visualization.fs",
+     "shaders/3.9.2.normal_visualization.gs"},
+    {"shaders/3.10.1.instancing.vs", "shaders/3.10.1.instancing.fs", nullptr},
+    {"shaders/3.11.1.skinning.vs", "shaders/3.11.1.skinning.fs", nullptr},
+};
+
+int main()
+{
+    // Initialize GLFW with a hidden window, only the context is needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLExtensions::Get().Print();
+
+    auto measure = [](const char *label, bool useCache) {
+        ProgramBinaryCache::Get().Enabled = useCache;
+        shaderLoadStats = ShaderLoadStats();
+
+        double start = glfwGetTime();
+        for (const ProgramSources &sources : PROGRAMS)
+        {
+            Shader shader(sources.Vertex, sources.Fragment, sources.Geometry);
+            glDeleteProgram(shader.ID);
+        }
+        double milliseconds = (glfwGetTime() - start) * 1000.0;
+
+        std::cout << label << ": " << milliseconds << " ms for " << std::size(PROGRAMS)
+                  << " programs, reading the sources included" << std::endl;
+        shaderLoadStats.Print();
+    };
+
+    measure("without cache", false);
+    measure("cache, first use", true);
+    measure("cache, warm", true);
+
+    // everything is submitted first, in a real start the time up to FinishAll would load assets
+    {
+        ProgramBinaryCache::Get().Enabled = false;
+        shaderLoadStats = ShaderLoadStats();
+
+        double start = glfwGetTime();
+        ShaderLibrary library;
+        for (const ProgramSources &sources : PROGRAMS)
+        {
+            library.Add(sources.Vertex, sources.Vertex, sources.Fragment, sources.Geometry);
+        }
+        double submitted = (glfwGetTime() - start) * 1000.0;
+        library.FinishAll();
+        double milliseconds = (glfwGetTime() - start) * 1000.0;
+
+        std::cout << "deferred without cache: " << milliseconds << " ms for "
+                  << library.GetCount() << " programs, " << submitted << " ms of it submitting"
+                  << std::endl;
+        shaderLoadStats.Print();
+    }
+
+    glfwTerminate();
+    return 0;
+}
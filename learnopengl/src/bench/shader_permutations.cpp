@@ -0,0 +1,157 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <frame_uniforms.h>
+#include <gl_ext.h>
+#include <shader_library.h>
+
+// Covers the screen LAYERS_PER_FRAME times with a quad lit by permutations of the multiple lights
+// shader, from every light type down to a single directional light, and prints the frame time of
+// each. The quad is a single draw, so the time is almost all fragment shading.
+
+const int LAYERS_PER_FRAME = 32;
+const int FRAMES_PER_PERMUTATION = 50;
+const int VIEWPORT_SIZE = 1024;
+
+struct PermutationCase
+{
+    const char *Label;
+    std::vector<std::string> Keywords;
+};
+
+int main()
+{
+    // Initialize GLFW with a hidden window, rendering into its default framebuffer
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window =
+        glfwCreateWindow(VIEWPORT_SIZE, VIEWPORT_SIZE, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    glViewport(0, 0, VIEWPORT_SIZE, VIEWPORT_SIZE);
+
+    {
+        ShaderLibrary shaders;
+        shaders.AddPermutations("lights",
+                                "shaders/2.6.1.multiplelights.vs",
+                                "shaders/2.6.1.multiplelights.fs",
+                                nullptr,
+                                {"DIRECTIONAL_LIGHT",
+                                 "POINT_LIGHTS",
+                                 "NUM_POINT_LIGHTS",
+                                 "SPOT_LIGHT"});
+
+        // every permutation is requested before any is used, they build side by side
+        std::vector<PermutationCase> cases = {
+            {"all lights", {}},
+            {"point lights", {"POINT_LIGHTS"}},
+            {"directional and spot light", {"DIRECTIONAL_LIGHT", "SPOT_LIGHT"}},
+            {"one point light", {"POINT_LIGHTS", "NUM_POINT_LIGHTS 1"}},
+            {"directional light", {"DIRECTIONAL_LIGHT"}},
+        };
+        std::vector<Shader *> programs;
+        for (const PermutationCase &permutation : cases)
+        {
+            programs.push_back(shaders.GetPermutation("lights", permutation.Keywords));
+        }
+
+        // a quad over the whole screen at the origin, facing the camera
+        float quad[] = {
+            // positions         // normals         // texture coords
+            -1.0f, -1.0f, 0.0f,  0.0f, 0.0f, 1.0f,  0.0f, 0.0f,
+             1.0f, -1.0f, 0.0f,  0.0f, 0.0f, 1.0f,  1.0f, 0.0f,
+            -1.0f,  1.0f, 0.0f,  0.0f, 0.0f, 1.0f,  0.0f, 1.0f,
+             1.0f,  1.0f, 0.0f,  0.0f, 0.0f, 1.0f,  1.0f, 1.0f,
+        };
+        unsigned int vao, vbo;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(
+            1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(
+            2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *)(6 * sizeof(float)));
+
+        // the quad is already in clip space
+        FrameUniforms frameUniforms;
+        glm::mat4 identity(1.0f);
+
+        for (size_t i = 0; i < cases.size(); ++i)
+        {
+            Shader &shader = *programs[i];
+            shader.Use();
+            shader.SetMat4x4("model", identity);
+            shader.SetVec3("viewPos", 0.0f, 0.0f, 3.0f);
+            shader.SetFloat("material.shininess", 32.0f);
+            // lights a permutation leaves out have no uniforms, setting them does nothing
+            shader.SetVec3("directionalLight.direction", -0.2f, -1.0f, -0.3f);
+            shader.SetVec3("directionalLight.diffuse", 0.4f, 0.4f, 0.4f);
+            for (int light = 0; light < 4; ++light)
+            {
+                std::string name = "pointLights[" + std::to_string(light) + "]";
+                shader.SetVec3(name + ".position", light - 1.5f, 0.0f, 1.0f);
+                shader.SetVec3(name + ".diffuse", 0.8f, 0.8f, 0.8f);
+                shader.SetFloat(name + ".constant", 1.0f);
+                shader.SetFloat(name + ".linear", 0.09f);
+                shader.SetFloat(name + ".quadratic", 0.032f);
+            }
+            shader.SetVec3("spotLight.position", 0.0f, 0.0f, 3.0f);
+            shader.SetVec3("spotLight.direction", 0.0f, 0.0f, -1.0f);
+            shader.SetVec3("spotLight.diffuse", 1.0f, 1.0f, 1.0f);
+            shader.SetFloat("spotLight.cutOff", std::cos(glm::radians(12.5f)));
+            shader.SetFloat("spotLight.outerCutOff", std::cos(glm::radians(15.0f)));
+            shader.SetFloat("spotLight.constant", 1.0f);
+
+            double start = glfwGetTime();
+            for (int frame = 0; frame < FRAMES_PER_PERMUTATION; ++frame)
+            {
+                glClear(GL_COLOR_BUFFER_BIT);
+                frameUniforms.Upload(identity, identity);
+                for (int layer = 0; layer < LAYERS_PER_FRAME; ++layer)
+                {
+                    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+                }
+                glfwSwapBuffers(window);
+            }
+            glFinish();
+            double frameTime = (glfwGetTime() - start) / FRAMES_PER_PERMUTATION;
+
+            std::cout << cases[i].Label << ": " << frameTime * 1000.0 << " ms per frame"
+                      << std::endl;
+        }
+
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include <animation.h>
+#include <frame_stats.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
+#include <job_system.h>
+#include <model.h>
+#include <shader.h>
+
+// Poses CHARACTER_COUNT characters sharing one animated model, each at its own point in the
+// animation, and prints how long evaluating all poses takes per frame and how many poses that is
+// per second. Poses are evaluated on the calling thread and then on the job system, the last pass
+// also uploads every published pose to a BoneMatrixBuffer while the next ones are evaluated, the
+// way a frame would draw each character. Finally one character is drawn with the skinning shader.
+//
+// usage: skinning [model path], defaults to a two bone column bending over
+
+const char *const DEFAULT_MODEL_PATH = "models/skinned_column/skinned_column.gltf";
+const int CHARACTER_COUNT = 1000;
+const int FRAMES_PER_MODE = 100;
+const float FRAME_TIME = 1.0f / 60.0f;
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : DEFAULT_MODEL_PATH;
+
+    // Initialize GLFW with a hidden window, the model still needs a context to upload into
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    glEnable(GL_DEPTH_TEST);
+
+    {
+        stbi_set_flip_vertically_on_load(true);
+        Model character(path);
+        Skeleton skeleton = character.GetSkeleton();
+        Animation animation(path, skeleton);
+        if (!animation.IsLoaded())
+        {
+            glfwTerminate();
+            return -1;
+        }
+        std::cout << path << ": " << skeleton.NodeNames.size() << " nodes, "
+                  << skeleton.GetBoneCount() << " bones, " << animation.Channels.size()
+                  << " animated channels, " << animation.Duration << " s" << std::endl;
+
+        // spread the characters over the whole animation so they don't all hit the same keys
+        vector<Animator> animators(CHARACTER_COUNT, Animator(skeleton));
+        for (int i = 0; i < CHARACTER_COUNT; ++i)
+        {
+            animators[i].Play(&animation);
+            animators[i].Update(animation.Duration * i / CHARACTER_COUNT);
+        }
+        BoneMatrixBuffer boneBuffer;
+
+        AnimationBatch batch;
+
+        auto evaluateSerial = [&]() {
+            for (Animator &animator : animators)
+            {
+                animator.Update(FRAME_TIME);
+            }
+        };
+        auto evaluateJobs = [&]() {
+            batch.Begin(animators, FRAME_TIME);
+            batch.Finish();
+        };
+        auto evaluateJobsAndUpload = [&]() {
+            batch.Begin(animators, FRAME_TIME);
+            for (const Animator &animator : animators)
+            {
+                boneBuffer.Upload(animator.GetBoneMatrices());
+            }
+            batch.Finish();
+        };
+
+        auto measure = [&](const char *label, auto evaluateFrame) {
+            double start = glfwGetTime();
+            for (int frame = 0; frame < FRAMES_PER_MODE; ++frame)
+            {
+                evaluateFrame();
+            }
+            glFinish();
+            double frameTime = (glfwGetTime() - start) / FRAMES_PER_MODE;
+
+            std::cout << label << ", " << CHARACTER_COUNT << " characters: "
+                      << frameTime * 1000.0 << " ms per frame, "
+                      << CHARACTER_COUNT / frameTime / 1000.0 << " thousand poses per second"
+                      << std::endl;
+        };
+
+        std::cout << "job system: " << JobSystem::Get().GetWorkerCount() << " workers"
+                  << std::endl;
+        measure("pose evaluation, render thread", evaluateSerial);
+        measure("pose evaluation, job system", evaluateJobs);
+        measure("pose evaluation, job system, overlapped with uploads", evaluateJobsAndUpload);
+
+        // the GPU side: one posed character through shaders/3.11.1.skinning.vs
+        Shader skinningShader("shaders/3.11.1.skinning.vs", "shaders/3.11.1.skinning.fs");
+        FrameUniforms frameUniforms;
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, -1.0f, -5.0f));
+
+        frameStats.Reset();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        frameUniforms.Upload(projection, view);
+        skinningShader.Use();
+        character.DrawSkinned(skinningShader, glm::mat4(1.0f), animators[0], boneBuffer);
+        glFinish();
+        std::cout << "skinned draw: " << frameStats.DrawCalls << " draw calls, "
+                  << frameStats.TrianglesDrawn << " triangles, GL error " << glGetError()
+                  << std::endl;
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <vector>
+
+#include <gl_ext.h>
+#include <shader.h>
+#include <stream_buffer.h>
+
+// Streams MEGABYTES_PER_FRAME of vertex data per frame in CHUNK_BYTES pieces, each drawn as points
+// right after it is written, the way per object data is written and drawn. It runs through
+// glBufferSubData into one buffer, as the demos upload their data, and then through a StreamBuffer
+// in each of its modes, and prints the frame time and upload rate of each.
+
+const size_t MEGABYTES_PER_FRAME = 16;
+const size_t CHUNK_BYTES = 64 * 1024;
+const int FRAMES_PER_MODE = 200;
+
+int main()
+{
+    // Initialize GLFW with a hidden window, only the context is needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    GLExtensions::Get().Print();
+
+    {
+        // any shader reading positions from location 0 will do, the points only have to be drawn
+        Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+        shader.Use();
+
+        size_t frameBytes = MEGABYTES_PER_FRAME * 1024 * 1024;
+        size_t chunkCount = frameBytes / CHUNK_BYTES;
+        GLsizei chunkPoints = static_cast<GLsizei>(CHUNK_BYTES / sizeof(glm::vec3));
+        std::vector<unsigned char> source(CHUNK_BYTES, 0);
+
+        unsigned int vao;
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        glEnableVertexAttribArray(0);
+
+        auto report = [&](const char *label, double seconds, unsigned int stalls) {
+            double frameTime = seconds / FRAMES_PER_MODE;
+            std::cout << label << ": " << frameTime * 1000.0 << " ms per frame, "
+                      << MEGABYTES_PER_FRAME / frameTime / 1024.0 << " GB/s, " << stalls
+                      << " stalls" << std::endl;
+        };
+
+        // every chunk into the same buffer, each update has to wait for the draw before it
+        {
+            unsigned int buffer;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_ARRAY_BUFFER, buffer);
+            glBufferData(GL_ARRAY_BUFFER, CHUNK_BYTES, NULL, GL_STREAM_DRAW);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)0);
+
+            double start = glfwGetTime();
+            for (int frame = 0; frame < FRAMES_PER_MODE; ++frame)
+            {
+                for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+                {
+                    source[0] = static_cast<unsigned char>(chunk);
+                    glBufferSubData(GL_ARRAY_BUFFER, 0, CHUNK_BYTES, source.data());
+                    glDrawArrays(GL_POINTS, 0, chunkPoints);
+                }
+                glfwSwapBuffers(window);
+            }
+            glFinish();
+            report("glBufferSubData", glfwGetTime() - start, 0);
+            glDeleteBuffers(1, &buffer);
+        }
+
+        // the whole frame is written first and drawn after the commit, unmapped buffers can't be
+        // drawn from without persistent mapping
+        auto measure = [&](const char *label, StreamBufferMode mode) {
+            StreamBuffer stream(GL_ARRAY_BUFFER, frameBytes, mode);
+            if (stream.GetMode() != mode)
+            {
+                std::cout << label << ": not supported" << std::endl;
+                return;
+            }
+            std::vector<size_t> offsets(chunkCount);
+
+            double start = glfwGetTime();
+            for (int frame = 0; frame < FRAMES_PER_MODE; ++frame)
+            {
+                stream.BeginFrame();
+                for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+                {
+                    source[0] = static_cast<unsigned char>(chunk);
+                    offsets[chunk] = stream.Write(source.data(), source.size()).Offset;
+                }
+                stream.Commit();
+
+                glBindBuffer(GL_ARRAY_BUFFER, stream.GetBuffer());
+                for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+                {
+                    glVertexAttribPointer(
+                        0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *)offsets[chunk]);
+                    glDrawArrays(GL_POINTS, 0, chunkPoints);
+                }
+                glfwSwapBuffers(window);
+            }
+            glFinish();
+            report(label, glfwGetTime() - start, stream.GetStallCount());
+        };
+
+        measure("stream buffer, persistent", StreamBufferMode::Persistent);
+        measure("stream buffer, unsynchronized", StreamBufferMode::Unsynchronized);
+        measure("stream buffer, orphaning", StreamBufferMode::Orphaning);
+
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    glfwTerminate();
+    return 0;
+}
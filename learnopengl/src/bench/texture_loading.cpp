@@ -0,0 +1,77 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <iostream>
+
+#include <model.h>
+
+// Compares how long loading the backpack takes with its textures decoded serially on the GL thread
+// versus decoded on worker threads. The mesh cache stays enabled so geometry import doesn't drown
+// out the difference.
+
+const int RUNS_PER_MODE = 5;
+
+double LoadBackpack(bool parallelDecode);
+
+int main()
+{
+    // Initialize GLFW with a hidden window, only the context is needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    stbi_set_flip_vertically_on_load(true);
+
+    // warm up the file system cache and write the mesh cache
+    LoadBackpack(true);
+
+    double serialTotal = 0.0;
+    double parallelTotal = 0.0;
+    for (int i = 0; i < RUNS_PER_MODE; ++i)
+    {
+        serialTotal += LoadBackpack(false);
+        parallelTotal += LoadBackpack(true);
+    }
+
+    double serial = serialTotal / RUNS_PER_MODE;
+    double parallel = parallelTotal / RUNS_PER_MODE;
+    std::cout << "backpack load, serial texture decode:   " << serial * 1000.0 << " ms" << std::endl;
+    std::cout << "backpack load, parallel texture decode: " << parallel * 1000.0 << " ms" << std::endl;
+    std::cout << "speedup: " << serial / parallel << "x" << std::endl;
+
+    glfwTerminate();
+    return 0;
+}
+
+/// <summary>
+/// Loads the backpack once and returns the time it took in seconds, GPU uploads included.
+/// </summary>
+double LoadBackpack(bool parallelDecode)
+{
+    ModelLoadOptions options;
+    options.ParallelTextureDecode = parallelDecode;
+
+    // the model releases the last reference to its textures when it goes out of scope, so every
+    // run decodes them again instead of hitting the shared texture cache
+    double start = glfwGetTime();
+    Model backpack("models/backpack/backpack.obj", false, options);
+    glFinish();
+    return glfwGetTime() - start;
+}
@@ -0,0 +1,107 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+
+#include <frame_stats.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
+#include <material.h>
+#include <model.h>
+#include <shader.h>
+
+// Draws the backpack scene of main two ways and prints the driver calls of one frame of each. The
+// first sets the model matrix and every sampler by name with a glGetUniformLocation per call, the
+// way every draw used to; the second goes through Model::Draw and the tables Shader builds once
+// after linking.
+
+const int FRAMES_PER_MODE = 100;
+
+int main()
+{
+    // Initialize GLFW with a hidden window, only the context is needed
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "LearnOpenGL Bench", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    glEnable(GL_DEPTH_TEST);
+
+    {
+        Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+
+        stbi_set_flip_vertically_on_load(true);
+        Model backpack("models/backpack/backpack.obj");
+
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+        glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -5.0f));
+        glm::mat4 model(1.0f);
+        FrameUniforms frameUniforms;
+
+        auto measure = [&](const char *label, auto drawFrame) {
+            double start = glfwGetTime();
+            for (int frame = 0; frame < FRAMES_PER_MODE; ++frame)
+            {
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                frameStats.Reset();
+                frameUniforms.Upload(projection, view);
+                shader.Use();
+                drawFrame();
+            }
+            glFinish();
+            double frameTime = (glfwGetTime() - start) / FRAMES_PER_MODE;
+
+            std::cout << label << ": " << frameTime * 1000.0 << " ms per frame" << std::endl;
+            frameStats.Print(); // the counters of the last frame
+        };
+
+        // every uniform looked up by name on every set, as Mesh::Draw and main did before
+        measure("name lookups", [&]() {
+            const MaterialRegistry &materials = MaterialRegistry::Get();
+            glUniformMatrix4fv(glGetUniformLocation(shader.ID, "model"), 1, GL_FALSE, &model[0][0]);
+            ++frameStats.UniformLocationQueries;
+
+            backpack.Geometry.Bind();
+            for (const Mesh &mesh : backpack.Meshes)
+            {
+                const Material &material = materials.GetMaterial(mesh.MaterialID);
+                for (const MaterialBinding &binding : material.Bindings)
+                {
+                    const string &name = materials.GetSamplerName(binding.Sampler);
+                    glUniform1i(glGetUniformLocation(shader.ID, name.c_str()), binding.Unit);
+                    ++frameStats.UniformLocationQueries;
+                    glActiveTexture(GL_TEXTURE0 + binding.Unit);
+                    glBindTexture(GL_TEXTURE_2D, binding.TextureID);
+                    ++frameStats.TextureBinds;
+                }
+                mesh.DrawRange();
+            }
+            glBindVertexArray(0);
+            glActiveTexture(GL_TEXTURE0);
+        });
+
+        // locations from the table built after linking
+        measure("cached locations", [&]() { backpack.Draw(shader, model); });
+    }
+
+    glfwTerminate();
+    return 0;
+}
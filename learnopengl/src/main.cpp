@@ -7,8 +7,12 @@
 #include <iostream>
 
 #include <shader.h>
+#include <shader_library.h>
 #include <camera.h>
 #include <model.h>
+#include <frame_stats.h>
+#include <frame_uniforms.h>
+#include <gl_ext.h>
 
 // Function declerations
 void ProcessInput(GLFWwindow *window);
@@ -31,6 +35,7 @@ float lastMouseY = (float)WINDOW_HEIGHT / 2.0f;
 // Timing
 float deltaTime = 0.0f;     // Time between current frame and last frame
 float lastFrameTime = 0.0f; // Time of last frame
+float lastStatsTime = 0.0f; // Time the frame stats were last printed
 
 int main()
 {
@@ -64,61 +69,89 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    LoadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // Configure global OpenGL state
     glEnable(GL_DEPTH_TEST);
 
 
-    // Build and compile the shader program
-    Shader shader("shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
-    Shader normalShader("shaders/3.9.2.normal_visualization.vs", 
-                        "shaders/3.9.2.normal_visualization.fs", 
-                        "shaders/3.9.2.normal_visualization.gs");
-
-
-    stbi_set_flip_vertically_on_load(true);
-    Model backpack("models/backpack/backpack.obj");
-
-    // uncomment to enable wireframes
-    // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-    // Main Loop
-    while (!glfwWindowShouldClose(window))
+    // everything owning GL objects lives in this scope, so it is released before the context goes
     {
-        // Time
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrameTime;
-        lastFrameTime = currentFrame;
-
-        // Input Handling
-        ProcessInput(window);
-
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // configure transformation matrices
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 1.0f, 100.0f);
-        glm::mat4 view = camera.GetViewMatrix();;
-        glm::mat4 model = glm::mat4(1.0f);
-        shader.Use();
-        shader.SetMat4x4("projection", projection);
-        shader.SetMat4x4("view", view);
-        shader.SetMat4x4("model", model);
-
-        // draw model as usual
-        backpack.Draw(shader);
-
-        // then draw model with normal visualizing geometry shader
-        normalShader.Use();
-        normalShader.SetMat4x4("projection", projection);
-        normalShader.SetMat4x4("view", view);
-        normalShader.SetMat4x4("model", model);
-
-        backpack.Draw(normalShader);
-
-        // Swaps the 2d buffer that contains color values for each pixel
-        glfwSwapBuffers(window);
-        glfwPollEvents(); // Checks for events being triggered (input)
+        // Submit the shader programs, the driver builds them while the model loads
+        ShaderLibrary shaders;
+        Shader &shader =
+            shaders.Add("default", "shaders/3.9.2.default.vs", "shaders/3.9.2.default.fs");
+        Shader &normalShader = shaders.Add("normals",
+                                           "shaders/3.9.2.normal_visualization.vs",
+                                           "shaders/3.9.2.normal_visualization.fs",
+                                           "shaders/3.9.2.normal_visualization.gs");
+        // edits saved to the sources show up without restarting
+        shaders.EnableHotReload();
+
+        // the camera of every program, uploaded once per frame
+        FrameUniforms frameUniforms;
+
+
+        stbi_set_flip_vertically_on_load(true);
+        ModelLoadOptions loadOptions;
+        loadOptions.Format = VertexFormat::Compact;
+        loadOptions.OptimizeMeshes = true;
+        Model backpack("models/backpack/backpack.obj", false, loadOptions);
+        backpack.GetMemoryUsage().Print("backpack");
+
+        shaders.FinishAll();
+        shaderLoadStats.Print();
+
+        RenderQueue renderQueue;
+
+        // uncomment to enable wireframes
+        // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+
+        // Main Loop
+        while (!glfwWindowShouldClose(window))
+        {
+            // Time
+            float currentFrame = glfwGetTime();
+            deltaTime = currentFrame - lastFrameTime;
+            lastFrameTime = currentFrame;
+            frameStats.Reset();
+            shaders.Update();
+            // without parallel shader compile saved shaders only apply on R, the swap stalls
+            if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS)
+            {
+                shaders.FinishReloads();
+            }
+
+            // Input Handling
+            ProcessInput(window);
+
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // configure transformation matrices
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT, 1.0f, 100.0f);
+            glm::mat4 view = camera.GetViewMatrix();;
+            glm::mat4 model = glm::mat4(1.0f);
+            frameUniforms.Upload(projection, view);
+
+            // queue the model as usual, then again with the normal visualizing geometry shader,
+            // the queue sorts both by state and sets the model matrix itself
+            renderQueue.Begin(projection, view, 100.0f);
+            backpack.Submit(renderQueue, shader, model);
+            backpack.Submit(renderQueue, normalShader, model, RenderPass::Overlay);
+            renderQueue.Flush();
+
+            // report the driver work of this frame about once a second
+            if (currentFrame - lastStatsTime >= 1.0f)
+            {
+                frameStats.Print();
+                lastStatsTime = currentFrame;
+            }
+
+            // Swaps the 2d buffer that contains color values for each pixel
+            glfwSwapBuffers(window);
+            glfwPollEvents(); // Checks for events being triggered (input)
+        }
     }
 
     glfwTerminate(); // Cleanup GLFW resources